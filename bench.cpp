@@ -0,0 +1,410 @@
+#include "game.h"
+#include "savegame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+struct BenchResult
+{
+    string name;
+    size_t entities;
+    int iterations;
+    double nsPerCall;
+    double nsPerEntity;
+};
+
+struct BenchRandom
+{
+    unsigned int seed = 12345;
+};
+
+float RandomFloat(BenchRandom &rng, float lo, float hi)
+{
+    rng.seed = rng.seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((rng.seed >> 8) / 16777216.0f);
+}
+
+void BuildSyntheticGame(Game &game, const LevelSet &levels, int targetCount, int missileCount, int towerCount,
+                        int fenceCount)
+{
+    BenchRandom rng;
+
+    InitializeGame(game, levels, 0);
+    game.secondPathActive = true;
+
+    for (int i = 0; i < targetCount; i++)
+    {
+        Target target;
+        target.radius = 0.5f;
+        target.active = true;
+        target.speed = 3.0f;
+        target.stopped = false;
+        target.pathIndex = i % 2;
+        target.pathDistance = RandomFloat(rng, 0.0f, game.paths[target.pathIndex].stopDistance);
+        target.pathSegment = 0;
+        target.position =
+            PathPosition(game.allWaypoints[target.pathIndex], game.paths[target.pathIndex], target.pathDistance,
+                         target.pathSegment);
+        AddTarget(game.targets, target);
+    }
+
+    for (int i = 0; i < missileCount; i++)
+    {
+        Missile missile;
+        missile.position = (Vector3){RandomFloat(rng, -20.0f, 20.0f), RandomFloat(rng, 0.0f, 4.0f),
+                                     RandomFloat(rng, -20.0f, 20.0f)};
+        missile.direction = (Vector3){1.0f, 0.0f, 0.0f};
+        missile.active = true;
+        missile.speed = 40.0f;
+        missile.lifetime = 2.0f;
+        AddMissile(game.missiles, missile);
+    }
+
+    for (int i = 0; i < towerCount; i++)
+    {
+        Tower tower;
+        float x = RandomFloat(rng, -15.0f, 15.0f);
+        float z = RandomFloat(rng, -15.0f, 15.0f);
+        tower.startPos = (Vector3){x, 0.1f, z - 2.0f};
+        tower.endPos = (Vector3){x, 0.1f, z + 2.0f};
+        tower.active = true;
+        tower.turretCooldown = 0.0f;
+        tower.turretRange = 13.0f;
+        tower.upgradeLevel = 3;
+        AddSlot(game.towers, tower);
+    }
+
+    for (int i = 0; i < fenceCount; i++)
+    {
+        Fence fence;
+        float x = RandomFloat(rng, -15.0f, 15.0f);
+        float z = RandomFloat(rng, -15.0f, 15.0f);
+        fence.startPos = (Vector3){x - 2.0f, 0.1f, z};
+        fence.endPos = (Vector3){x + 2.0f, 0.1f, z};
+        fence.fenceActive = true;
+        fence.fenceTimer = 0.0f;
+        fence.fenceContactTimer = 0.0f;
+        fence.fenceInContact = false;
+        PrepareFence(fence);
+        AddSlot(game.fences, fence);
+    }
+    game.towerCount = towerCount;
+    game.fenceCount = fenceCount;
+    // As BuyFence does, so UpdateTargets builds the fence grid for the new fences.
+    game.layoutVersion++;
+    BuildTargetGrid(game);
+}
+
+// Times one system on fresh copies of the base state so every iteration sees the same workload.
+template <typename Fn>
+BenchResult RunBench(const string &name, const Game &base, size_t entities, Fn system)
+{
+    const double minSeconds = 0.25;
+    const int minIterations = 3;
+    const int maxIterations = 1000;
+
+    double totalNs = 0.0;
+    int iterations = 0;
+    Game game;
+    while (iterations < maxIterations && (iterations < minIterations || totalNs < minSeconds * 1e9))
+    {
+        game = base;
+        auto start = chrono::steady_clock::now();
+        system(game);
+        totalNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        iterations++;
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.entities = entities;
+    result.iterations = iterations;
+    result.nsPerCall = totalNs / iterations;
+    result.nsPerEntity = result.nsPerCall / max((size_t)1, entities);
+    return result;
+}
+
+// Scheduling overhead per task with empty task bodies: independent tasks, a
+// chain where each task depends on the previous one, and ParallelFor chunks.
+void BenchScheduler(JobSystem &jobs, vector<BenchResult> &results)
+{
+    const int taskCount = 10000;
+    const int chainLength = 1000;
+    Game idle;
+
+    results.push_back(RunBench("SubmitTask/" + to_string(taskCount), idle, taskCount, [&jobs](Game &) {
+        TaskHandle finished = CreateTask([] {});
+        for (int i = 0; i < taskCount; i++)
+        {
+            TaskHandle task = CreateTask([] {});
+            AddDependency(task, finished);
+            SubmitTask(jobs, task);
+        }
+        SubmitTask(jobs, finished);
+        WaitTask(jobs, finished);
+    }));
+    results.push_back(RunBench("TaskChain/" + to_string(chainLength), idle, chainLength, [&jobs](Game &) {
+        TaskHandle first = CreateTask([] {});
+        TaskHandle previous = first;
+        for (int i = 1; i < chainLength; i++)
+        {
+            TaskHandle task = CreateTask([] {});
+            AddDependency(previous, task);
+            SubmitTask(jobs, task);
+            previous = task;
+        }
+        SubmitTask(jobs, first);
+        WaitTask(jobs, previous);
+    }));
+    results.push_back(RunBench("ParallelFor/" + to_string(taskCount), idle, taskCount, [&jobs](Game &) {
+        ParallelFor(&jobs, taskCount, 1, [](size_t, size_t, size_t) {});
+    }));
+}
+
+// Startup cost of a large level config: parsing the text against loading the
+// compiled cache, which still reads and hashes the text to check the key.
+void BenchLevels(vector<BenchResult> &results)
+{
+    const int levelCount = 1000;
+    const int pathPoints = 16;
+    const char *textPath = "kingshot-bench-levels.txt";
+    const char *cachePath = "kingshot-bench-levels.cache";
+    BenchRandom rng;
+
+    string text;
+    char line[64];
+    for (int level = 0; level < levelCount; level++)
+    {
+        text += "level bench" + to_string(level) + "\nenemies 15 5\nspawn_delay 1.0 0.1 0.3\nspeed 3.0 0.2 7.0\n";
+        for (int path = 0; path < 2; path++)
+        {
+            text += "path";
+            for (int i = 0; i < pathPoints; i++)
+            {
+                snprintf(line, sizeof(line), "  %.2f 0.1 %.2f", RandomFloat(rng, -20.0f, 20.0f),
+                         RandomFloat(rng, -20.0f, 20.0f));
+                text += line;
+            }
+            text += "\n";
+        }
+    }
+    FILE *file = fopen(textPath, "wb");
+    if (!file)
+        return;
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+
+    Game idle;
+    string error;
+    results.push_back(RunBench("ParseLevels/" + to_string(levelCount), idle, levelCount, [&](Game &) {
+        LevelSet set;
+        ParseLevels(set, text.data(), text.size(), error);
+    }));
+    LevelSet set;
+    LoadLevels(set, textPath, cachePath, error);
+    results.push_back(RunBench("LoadLevelsCached/" + to_string(levelCount), idle, levelCount, [&](Game &) {
+        LevelSet set;
+        LoadLevels(set, textPath, cachePath, error);
+    }));
+    remove(textPath);
+    remove(cachePath);
+}
+
+void WriteJson(const char *path, const vector<BenchResult> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        return;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"entities\": %zu, \"iterations\": %d, \"ns_per_call\": %.1f, "
+                "\"ns_per_entity\": %.3f}%s\n",
+                r.name.c_str(), r.entities, r.iterations, r.nsPerCall, r.nsPerEntity,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+}
+
+// Reads the name/ns_per_entity pairs back out of a file written by WriteJson.
+vector<BenchResult> ReadJson(const char *path)
+{
+    vector<BenchResult> results;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return results;
+    }
+    string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        text.append(buffer, n);
+    }
+    fclose(file);
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != string::npos)
+    {
+        pos += 9;
+        size_t end = text.find('"', pos);
+        size_t value = text.find("\"ns_per_entity\": ", end);
+        if (end == string::npos || value == string::npos)
+            break;
+        BenchResult result = {};
+        result.name = text.substr(pos, end - pos);
+        result.nsPerEntity = atof(text.c_str() + value + 17);
+        results.push_back(result);
+        pos = value;
+    }
+    return results;
+}
+
+void PrintUsage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  -q              quick run, skip the 100k target state\n");
+    printf("  -o <file>       write results as JSON\n");
+    printf("  -b <file>       compare against a JSON baseline written with -o\n");
+    printf("  -j <threads>    threads for the parallel systems, including this one (default 1)\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = false;
+    const char *jsonPath = nullptr;
+    const char *baselinePath = nullptr;
+    int threads = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-q") == 0)
+            quick = true;
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            threads = atoi(argv[++i]);
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const int targetCounts[] = {1000, 10000, 100000};
+    const int missileCount = 2000;
+    const int towerCount = 256;
+    const int fenceCount = 64;
+    const float dt = 1.0f / 60.0f;
+
+    LevelSet levels;
+    string error;
+    if (!LoadLevels(levels, levelsPath, levelsCachePath, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    JobSystem jobs;
+    StartJobSystem(jobs, threads - 1);
+
+    vector<BenchResult> results;
+    for (int targetCount : targetCounts)
+    {
+        if (quick && targetCount > 10000)
+            continue;
+
+        Game base;
+        BuildSyntheticGame(base, levels, targetCount, missileCount, towerCount, fenceCount);
+        base.jobs = &jobs;
+        string suffix = "/" + to_string(targetCount);
+
+        results.push_back(RunBench("UpdateTargets" + suffix, base, base.targets.size(),
+                                   [dt](Game &game) { UpdateTargets(game, dt); }));
+        Game moving = base;
+        UpdateTargets(moving, dt);
+        results.push_back(RunBench("MoveTargets" + suffix, moving, moving.targets.size(),
+                                   [dt](Game &game) { MoveTargets(game, dt, 0, game.targets.size()); }));
+        Game flowing = moving;
+        flowing.navigation = NAVIGATION_FLOW_FIELD;
+        BuildFlowField(flowing);
+        results.push_back(RunBench("MoveTargetsFlow" + suffix, flowing, flowing.targets.size(),
+                                   [dt](Game &game) { MoveTargets(game, dt, 0, game.targets.size()); }));
+        results.push_back(RunBench("BuildFlowField" + suffix, flowing, flowing.flowField.blocked.size(),
+                                   [](Game &game) { BuildFlowField(game); }));
+        results.push_back(
+            RunBench("UpdateFences" + suffix, base, base.fences.size(), [](Game &game) { UpdateFences(game); }));
+        results.push_back(RunBench("BuildTargetGrid" + suffix, base, base.targets.size(),
+                                   [](Game &game) { BuildTargetGrid(game); }));
+        results.push_back(RunBench("UpdateTowers" + suffix, base, base.towers.size(),
+                                   [dt](Game &game) { UpdateTowers(game, dt); }));
+        results.push_back(RunBench("UpdateMissiles" + suffix, base, base.missiles.size(),
+                                   [dt](Game &game) { UpdateMissiles(game, dt); }));
+
+        const char *savePath = "kingshot-bench.sav";
+        results.push_back(RunBench("SaveGame" + suffix, base, base.targets.size(),
+                                   [savePath](Game &game) { SaveGame(game, savePath); }));
+        results.push_back(RunBench("LoadGame" + suffix, base, base.targets.size(),
+                                   [savePath](Game &game) { LoadGame(game, savePath); }));
+        remove(savePath);
+    }
+
+    // Without workers ParallelFor runs inline and nothing is ever queued, so
+    // the scheduler rows get a pool with one worker of their own.
+    if (jobs.workers.empty())
+    {
+        printf("scheduler rows run with 1 worker thread\n");
+        JobSystem schedulerJobs;
+        StartJobSystem(schedulerJobs, 1);
+        BenchScheduler(schedulerJobs, results);
+        StopJobSystem(schedulerJobs);
+    }
+    else
+    {
+        BenchScheduler(jobs, results);
+    }
+    BenchLevels(results);
+
+    vector<BenchResult> baseline;
+    if (baselinePath)
+    {
+        baseline = ReadJson(baselinePath);
+    }
+
+    printf("%-24s %10s %8s %14s %14s %10s\n", "benchmark", "entities", "iters", "ns/call", "ns/entity",
+           baselinePath ? "vs base" : "");
+    for (const auto &r : results)
+    {
+        printf("%-24s %10zu %8d %14.1f %14.3f", r.name.c_str(), r.entities, r.iterations, r.nsPerCall, r.nsPerEntity);
+        for (const auto &b : baseline)
+        {
+            if (b.name == r.name && b.nsPerEntity > 0.0)
+            {
+                printf(" %+9.1f%%", (r.nsPerEntity / b.nsPerEntity - 1.0) * 100.0);
+                break;
+            }
+        }
+        printf("\n");
+    }
+
+    if (jsonPath)
+    {
+        WriteJson(jsonPath, results);
+    }
+    StopJobSystem(jobs);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "flowfield.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Integer step costs keep the search exact: 5 and 7 are within 1% of 1 : sqrt(2).
+const int straightCost = 5;
+const int diagonalCost = 7;
+const int unreachable = INT_MAX;
+static const int offsetX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int offsetZ[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+// Calls visit(next, stepCost, n) for each open cell one step from cell, where
+// n indexes the offset tables.
+template <typename Fn>
+static void ForNeighbours(const FlowField &field, int cell, Fn visit)
+{
+    int cellX = cell % field.width;
+    int cellZ = cell / field.width;
+    for (int n = 0; n < 8; n++)
+    {
+        int x = cellX + offsetX[n];
+        int z = cellZ + offsetZ[n];
+        if (x < 0 || z < 0 || x >= field.width || z >= field.height || field.blocked[z * field.width + x])
+            continue;
+        bool diagonal = offsetX[n] != 0 && offsetZ[n] != 0;
+        if (diagonal && (field.blocked[cellZ * field.width + x] || field.blocked[z * field.width + cellX]))
+            continue;
+        visit(z * field.width + x, diagonal ? diagonalCost : straightCost, n);
+    }
+}
+
+// Covers [minX, maxX] x [minZ, maxZ] with open cells.
+void ResetFlowField(FlowField &field, float minX, float minZ, float maxX, float maxZ, float cellSize)
+{
+    field.cellSize = cellSize;
+    field.minX = minX;
+    field.minZ = minZ;
+    field.width = max(1, (int)ceilf((maxX - minX) / cellSize));
+    field.height = max(1, (int)ceilf((maxZ - minZ) / cellSize));
+    size_t cells = (size_t)field.width * field.height;
+    field.blocked.assign(cells, 0);
+    field.cost.assign(cells, unreachable);
+    field.directionX.assign(cells, 0.0f);
+    field.directionZ.assign(cells, 0.0f);
+}
+
+// Blocks every cell whose center lies inside the box.
+void BlockFlowField(FlowField &field, float minX, float minZ, float maxX, float maxZ)
+{
+    int firstX = max(0, (int)ceilf((minX - field.minX) / field.cellSize - 0.5f));
+    int lastX = min(field.width - 1, (int)floorf((maxX - field.minX) / field.cellSize - 0.5f));
+    int firstZ = max(0, (int)ceilf((minZ - field.minZ) / field.cellSize - 0.5f));
+    int lastZ = min(field.height - 1, (int)floorf((maxZ - field.minZ) / field.cellSize - 0.5f));
+    for (int cellZ = firstZ; cellZ <= lastZ; cellZ++)
+    {
+        for (int cellX = firstX; cellX <= lastX; cellX++)
+        {
+            field.blocked[cellZ * field.width + cellX] = 1;
+        }
+    }
+}
+
+void SolveFlowField(FlowField &field, float goalX, float goalZ)
+{
+    field.cost.assign(field.blocked.size(), unreachable);
+    field.directionX.assign(field.blocked.size(), 0.0f);
+    field.directionZ.assign(field.blocked.size(), 0.0f);
+    int goal = FlowFieldCell(field, goalX, goalZ);
+    if (goal < 0)
+        return;
+    field.blocked[goal] = 0;
+
+    typedef pair<int, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+    field.cost[goal] = 0;
+    open.push(Entry(0, goal));
+    while (!open.empty())
+    {
+        Entry entry = open.top();
+        open.pop();
+        if (entry.first != field.cost[entry.second])
+            continue;
+        ForNeighbours(field, entry.second, [&](int next, int stepCost, int) {
+            int cost = entry.first + stepCost;
+            if (cost < field.cost[next])
+            {
+                field.cost[next] = cost;
+                open.push(Entry(cost, next));
+            }
+        });
+    }
+
+    // Point each reachable cell at the neighbour its shortest path goes
+    // through. Ties go to the first in neighbour order, so the field is the
+    // same on every build.
+    const float diagonalLength = sqrtf(0.5f);
+    for (int cell = 0; cell < (int)field.cost.size(); cell++)
+    {
+        if (field.cost[cell] == unreachable || cell == goal)
+            continue;
+        int best = unreachable;
+        int bestDirection = -1;
+        ForNeighbours(field, cell, [&](int next, int stepCost, int n) {
+            if (field.cost[next] != unreachable && field.cost[next] + stepCost < best)
+            {
+                best = field.cost[next] + stepCost;
+                bestDirection = n;
+            }
+        });
+        if (bestDirection < 0)
+            continue;
+        bool diagonal = offsetX[bestDirection] != 0 && offsetZ[bestDirection] != 0;
+        field.directionX[cell] = offsetX[bestDirection] * (diagonal ? diagonalLength : 1.0f);
+        field.directionZ[cell] = offsetZ[bestDirection] * (diagonal ? diagonalLength : 1.0f);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// Navigation grid on the XZ plane. SolveFlowField runs Dijkstra outward from
+// the goal over the open cells, 8-connected without cutting past blocked
+// corners, and leaves in each cell the unit direction to its next cell on a
+// shortest path to the goal. The goal cell and cells that cannot reach it
+// keep a zero direction, so every agent can share one field.
+struct FlowField
+{
+    float cellSize = 1.0f;
+    float minX = 0.0f;
+    float minZ = 0.0f;
+    int width = 0;
+    int height = 0;
+    vector<unsigned char> blocked;
+    vector<int> cost;
+    vector<float> directionX;
+    vector<float> directionZ;
+};
+
+void ResetFlowField(FlowField &field, float minX, float minZ, float maxX, float maxZ, float cellSize);
+void BlockFlowField(FlowField &field, float minX, float minZ, float maxX, float maxZ);
+void SolveFlowField(FlowField &field, float goalX, float goalZ);
+
+// Returns the index of the cell holding (x, z), or -1 outside the field.
+inline int FlowFieldCell(const FlowField &field, float x, float z)
+{
+    int cellX = (int)floorf((x - field.minX) / field.cellSize);
+    int cellZ = (int)floorf((z - field.minZ) / field.cellSize);
+    if (cellX < 0 || cellZ < 0 || cellX >= field.width || cellZ >= field.height)
+        return -1;
+    return cellZ * field.width + cellX;
+}
+
+// Looks up the direction to walk from (x, z). Returns false where the field
+// gives none: outside it, in the goal cell, or cut off from the goal.
+inline bool SampleFlowField(const FlowField &field, float x, float z, float &directionX, float &directionZ)
+{
+    int cell = FlowFieldCell(field, x, z);
+    if (cell < 0)
+        return false;
+    directionX = field.directionX[cell];
+    directionZ = field.directionZ[cell];
+    return directionX != 0.0f || directionZ != 0.0f;
+}
+
+#endif
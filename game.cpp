@@ -0,0 +1,792 @@
+#include "game.h"
+#include "raymath.h"
+#include "savegame.h"
+
+#include <algorithm>
+#include <cmath>
+
+void InitializeGame(Game &game, const LevelSet &levels, int level)
+{
+    const LevelInfo &info = levels.levels[level];
+    game.allWaypoints.resize(info.pathCount);
+    for (uint32_t p = 0; p < info.pathCount; p++)
+    {
+        const Vector3 *points = levels.points.data();
+        game.allWaypoints[p].assign(points + levels.pathStart[info.firstPath + p],
+                                    points + levels.pathStart[info.firstPath + p + 1]);
+    }
+    BuildPaths(game);
+    game.navigation = info.navigation;
+    if (game.navigation == NAVIGATION_FLOW_FIELD)
+    {
+        BuildFlowField(game);
+    }
+    game.waves = info.waves;
+    game.levelHash = info.hash;
+    game.maxEnemies = game.waves.baseEnemies;
+    game.spawnDelay = game.waves.spawnDelay;
+    game.target.speed = game.waves.enemySpeed;
+
+    game.missiles.slots.resize(game.maxMissiles);
+    game.missiles.count = 0;
+    ClearHandles(game.missiles.handles);
+}
+
+Handle AddMissile(MissilePool &pool, const Missile &missile)
+{
+    if (pool.count >= pool.slots.size())
+        return Handle();
+    pool.slots[pool.count++] = missile;
+    return CreateHandle(pool.handles);
+}
+
+void RemoveMissile(MissilePool &pool, size_t i)
+{
+    pool.slots[i] = pool.slots[--pool.count];
+    SwapRemoveHandle(pool.handles, i);
+}
+
+void FireMissile(Game &game, Vector3 position, Vector3 direction)
+{
+    const float missileSpeed = 40.0f;
+    const float missileLifetime = 2.0f;
+
+    Missile missile;
+    missile.position = position;
+    missile.direction = direction;
+    missile.active = true;
+    missile.speed = missileSpeed;
+    missile.lifetime = missileLifetime;
+    AddMissile(game.missiles, missile);
+}
+
+void BuyTower(Game &game)
+{
+    const float towerCost = 50.0f;
+    const int maxTowers = 4;
+    const int maxUpgrades = 3;
+
+    if (game.coins < towerCost)
+        return;
+
+    if (game.towerCount < maxTowers)
+    {
+        Tower tower;
+        tower.active = true;
+        tower.turretCooldown = 0.0f;
+        tower.turretRange = 7.0f;
+        tower.upgradeLevel = 0;
+        Vector3 playerPos = (Vector3){0.0f, 0.1f, 0.0f};
+        float baseDistance = 3.0f;
+        float distanceIncrease = 1.5f * ((float)game.towerCount / 4);
+        float distance = baseDistance + distanceIncrease;
+        float towerLength = 4.0f;
+        int positionIndex = game.towerCount % 4;
+        if (positionIndex == 0)
+        {
+            tower.startPos = (Vector3){-distance, playerPos.y, -towerLength / 2};
+            tower.endPos = (Vector3){-distance, playerPos.y, towerLength / 2};
+        }
+        else if (positionIndex == 1)
+        {
+            tower.startPos = (Vector3){distance, playerPos.y, -towerLength / 2};
+            tower.endPos = (Vector3){distance, playerPos.y, towerLength / 2};
+        }
+        else if (positionIndex == 2)
+        {
+            tower.startPos = (Vector3){-towerLength / 2, playerPos.y, distance};
+            tower.endPos = (Vector3){towerLength / 2, playerPos.y, distance};
+        }
+        else
+        {
+            tower.startPos = (Vector3){-towerLength / 2, playerPos.y, -distance};
+            tower.endPos = (Vector3){towerLength / 2, playerPos.y, -distance};
+        }
+        AddSlot(game.towers, tower);
+        game.coins -= towerCost;
+        game.towerCount++;
+        game.layoutVersion++;
+    }
+    else
+    {
+        game.canUpgrade = false;
+        for (auto &tower : game.towers)
+        {
+            if (tower.upgradeLevel < maxUpgrades)
+            {
+                game.canUpgrade = true;
+                break;
+            }
+        }
+        if (game.canUpgrade)
+        {
+            for (auto &tower : game.towers)
+            {
+                if (tower.upgradeLevel < maxUpgrades)
+                {
+                    tower.turretCooldown = max(0.5f, tower.turretCooldown - 0.5f);
+                    tower.turretRange += 2.0f;
+                    tower.upgradeLevel++;
+                    game.coins -= towerCost;
+                    game.layoutVersion++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Caches what the contact test in UpdateTargets needs, so it runs once per
+// placement instead of once per target per tick.
+void PrepareFence(Fence &fence)
+{
+    fence.direction = Vector3Subtract(fence.endPos, fence.startPos);
+    float lengthSquared = Vector3DotProduct(fence.direction, fence.direction);
+    fence.inverseLengthSquared = lengthSquared > 0.0f ? 1.0f / lengthSquared : 0.0f;
+    Vector3 halfWidth = (Vector3){fenceWidth / 2, fenceWidth / 2, fenceWidth / 2};
+    fence.bounds.min = Vector3Subtract(Vector3Min(fence.startPos, fence.endPos), halfWidth);
+    fence.bounds.max = Vector3Add(Vector3Max(fence.startPos, fence.endPos), halfWidth);
+}
+
+void BuyFence(Game &game)
+{
+    const float fenceCost = 20.0f;
+    const int maxTowers = 4;
+    const int maxFences = 256;
+    const float ringSpacing = 1.5f;
+
+    if (game.coins < fenceCost || game.towerCount != maxTowers || game.fenceCount >= maxFences)
+        return;
+
+    Fence fence;
+    fence.fenceActive = true;
+    fence.fenceContactTimer = 0.0f;
+    fence.fenceInContact = false;
+    fence.fenceContactTimeLimit = 3.0f;
+
+    float baseDistance = 3.0f;
+    float distanceIncrease = 1.5f * ((float)game.towerCount / 4);
+    // Every four fences start a new ring further out.
+    float distance = baseDistance + distanceIncrease + ringSpacing * (game.fenceCount / 4);
+    float towerLength = 4.0f;
+    int positionIndex = game.fenceCount % 4;
+
+    if (positionIndex == 0)
+    {
+        fence.startPos = (Vector3){-distance / 1.5f, 0.1f, -towerLength / 2};
+        fence.endPos = (Vector3){-distance / 1.5f, 0.1f, towerLength / 2};
+    }
+    else if (positionIndex == 1)
+    {
+        fence.startPos = (Vector3){distance / 1.3f, 0.1f, -towerLength / 2};
+        fence.endPos = (Vector3){distance / 1.3f, 0.1f, towerLength / 2};
+    }
+    else if (positionIndex == 2)
+    {
+        fence.startPos = (Vector3){-towerLength / 2, 0.1f, distance - 0.8f};
+        fence.endPos = (Vector3){towerLength / 2, 0.1f, distance - 0.8f};
+    }
+    else
+    {
+        fence.startPos = (Vector3){-towerLength / 2, 0.1f, -distance + 0.4f};
+        fence.endPos = (Vector3){towerLength / 2, 0.1f, -distance + 0.4f};
+    }
+    PrepareFence(fence);
+
+    AddSlot(game.fences, fence);
+    game.coins -= fenceCost;
+    game.fenceCount++;
+    game.layoutVersion++;
+}
+
+void ShowMessage(Game &game, const char *message)
+{
+    game.message = message;
+    game.messageCount++;
+}
+
+void ApplyCommand(Game &game, const Command &command)
+{
+    // Saving leaves the game as it was, so a recording can skip it. Loading
+    // swaps in another state and tick under the recorder that a replay could
+    // not reproduce, so it is refused while recording.
+    if (command.type == COMMAND_SAVE)
+    {
+        if (!SaveGame(game, quickSavePath))
+            ShowMessage(game, "Save failed");
+        return;
+    }
+    if (command.type == COMMAND_LOAD)
+    {
+        if (game.recorder != nullptr)
+            ShowMessage(game, "Loading is disabled while recording");
+        else if (!LoadGame(game, quickSavePath))
+            ShowMessage(game, "Load failed");
+        return;
+    }
+
+    if (game.recorder != nullptr)
+    {
+        RecordCommand(*game.recorder, game.tick, command);
+    }
+
+    if (command.type == COMMAND_PAUSE)
+    {
+        if (!game.gameOver)
+        {
+            game.pause = !game.pause;
+        }
+        return;
+    }
+    if (command.type == COMMAND_RESET)
+    {
+        if (game.gameOver)
+        {
+            ResetGame(game);
+        }
+        return;
+    }
+
+    if (game.pause || game.gameOver)
+        return;
+
+    switch (command.type)
+    {
+    case COMMAND_FIRE:
+        FireMissile(game, command.position, command.direction);
+        break;
+    case COMMAND_BUY_TOWER:
+        BuyTower(game);
+        break;
+    case COMMAND_BUY_FENCE:
+        BuyFence(game);
+        break;
+    default:
+        break;
+    }
+}
+
+void UpdateWave(Game &game, float dt)
+{
+    const WaveSchedule &waves = game.waves;
+
+    if (game.waveNumber >= waves.secondPathWave && !game.secondPathActive && game.allWaypoints.size() > 1)
+    {
+        game.secondPathActive = true;
+        game.maxEnemies = waves.baseEnemies + (game.waveNumber - 1) * waves.enemiesPerWave + waves.secondPathEnemies;
+    }
+
+    if (game.waveActive && game.targets.empty() && game.enemiesSpawned >= game.maxEnemies)
+    {
+        game.waveActive = false;
+        game.waveDelayTimer = 0.0f;
+    }
+
+    if (!game.waveActive)
+    {
+        game.waveDelayTimer += dt;
+        if (game.waveDelayTimer >= waves.waveDelay)
+        {
+            game.waveNumber++;
+            game.spawnDelay -= waves.spawnDelayStep;
+            if (game.spawnDelay <= waves.minSpawnDelay)
+            {
+                game.spawnDelay = waves.minSpawnDelay;
+            }
+            game.target.speed += waves.enemySpeedStep;
+            if (game.target.speed >= waves.maxEnemySpeed)
+            {
+                game.target.speed = waves.maxEnemySpeed;
+            }
+            game.maxEnemies = waves.baseEnemies + (game.waveNumber - 1) * waves.enemiesPerWave;
+            if (game.secondPathActive)
+            {
+                game.maxEnemies += waves.secondPathEnemies;
+            }
+            game.enemiesSpawned = 0;
+            game.waveActive = true;
+        }
+    }
+}
+void SpawnEnemies(Game &game, float dt)
+{
+    if (!game.waveActive || game.enemiesSpawned >= game.maxEnemies)
+    {
+        return;
+    }
+
+    game.spawnTimer += dt;
+    if (game.spawnTimer >= game.spawnDelay)
+    {
+        game.target.radius = 0.5f;
+        game.target.active = true;
+        game.target.speed = game.waves.enemySpeed;
+        game.target.pathDistance = 0.0f;
+        game.target.pathSegment = 0;
+        game.target.stopped = false;
+        game.target.lifeTimer = 0.0f;
+
+        if (game.secondPathActive)
+        {
+            game.target.pathIndex = (game.enemiesSpawned % 2);
+            game.target.position = game.allWaypoints[game.target.pathIndex][0];
+        }
+        else
+        {
+            game.target.pathIndex = 0;
+            game.target.position = game.allWaypoints[0][0];
+        }
+
+        AddTarget(game.targets, game.target);
+        game.enemiesSpawned++;
+        game.spawnTimer = 0.0f;
+    }
+}
+
+void UpdateTargets(Game &game, float dt)
+{
+    const float contactTimeLimit = 2.0f;
+    const size_t targetGrain = 1024;
+    TargetPool &targets = game.targets;
+    game.inContact = false;
+
+    if (game.fenceGridVersion != game.layoutVersion)
+    {
+        BuildFenceGrid(game);
+    }
+    if (game.navigation == NAVIGATION_FLOW_FIELD && game.flowFieldVersion != game.layoutVersion)
+    {
+        BuildFlowField(game);
+    }
+
+    size_t fenceCount = game.fences.size();
+    game.targetChunks.resize((targets.size() + targetGrain - 1) / targetGrain);
+    for (TargetChunk &chunk : game.targetChunks)
+    {
+        chunk.coins = 0;
+        chunk.freeTarget = false;
+        chunk.fenceContacts.assign(fenceCount, 0);
+        chunk.playerContacts = 0;
+        chunk.reachedEnd = false;
+    }
+
+    // Fences are only read here, so every target sees them as they were at the
+    // start of the tick; the contacts are applied to them below.
+    ParallelFor(game.jobs, targets.size(), targetGrain, [&](size_t begin, size_t end, size_t c) {
+        TargetChunk &chunk = game.targetChunks[c];
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!targets.active[i])
+                continue;
+            targets.stopped[i] = false;
+            Vector3 position = TargetPosition(targets, i);
+
+            // The grid can list a fence more than once; visiting them in index
+            // order matches a scan over every fence.
+            float radius = targets.radius[i];
+            chunk.nearbyFences.clear();
+            QuerySpatialGrid(game.fenceGrid, position.x, position.z, radius,
+                             [&](int f) { chunk.nearbyFences.push_back(f); });
+            sort(chunk.nearbyFences.begin(), chunk.nearbyFences.end());
+            chunk.nearbyFences.erase(unique(chunk.nearbyFences.begin(), chunk.nearbyFences.end()),
+                                     chunk.nearbyFences.end());
+
+            bool inContactWithFence = false;
+            for (int f : chunk.nearbyFences)
+            {
+                const Fence &fence = game.fences[f];
+                if (!fence.fenceActive || position.x < fence.bounds.min.x - radius ||
+                    position.x > fence.bounds.max.x + radius || position.y < fence.bounds.min.y - radius ||
+                    position.y > fence.bounds.max.y + radius || position.z < fence.bounds.min.z - radius ||
+                    position.z > fence.bounds.max.z + radius)
+                    continue;
+
+                Vector3 toTarget = Vector3Subtract(position, fence.startPos);
+                float t = Vector3DotProduct(toTarget, fence.direction) * fence.inverseLengthSquared;
+                t = max(0.0f, min(1.0f, t));
+                Vector3 closestPoint = Vector3Add(fence.startPos, Vector3Scale(fence.direction, t));
+                float distanceToFence = Vector3Distance(position, closestPoint);
+                if (distanceToFence < (radius + fenceWidth / 2))
+                {
+                    chunk.fenceContacts[f]++;
+                    targets.stopped[i] = true;
+                    inContactWithFence = true;
+                    targets.lifeTimer[i] += dt;
+                    if (targets.lifeTimer[i] >= targets.lifeTimeLimit[i])
+                    {
+                        targets.active[i] = false;
+                        chunk.coins += 1;
+                    }
+                }
+            }
+
+            if (!inContactWithFence)
+            {
+                targets.lifeTimer[i] = 0.0f;
+                chunk.freeTarget = true;
+            }
+        }
+    });
+
+    bool freeTarget = false;
+    for (const TargetChunk &chunk : game.targetChunks)
+    {
+        game.coins += chunk.coins;
+        freeTarget = freeTarget || chunk.freeTarget;
+        for (size_t f = 0; f < fenceCount; f++)
+        {
+            Fence &fence = game.fences[f];
+            for (int n = 0; n < chunk.fenceContacts[f]; n++)
+            {
+                fence.fenceInContact = true;
+                fence.fenceContactTimer += dt;
+            }
+        }
+    }
+    for (auto &fence : game.fences)
+    {
+        if (fence.fenceActive && fence.fenceContactTimer >= fence.fenceContactTimeLimit)
+        {
+            fence.fenceActive = false;
+        }
+        else if (freeTarget && fence.fenceActive && !fence.fenceInContact)
+        {
+            fence.fenceContactTimer = 0.0f;
+        }
+    }
+
+    ParallelFor(game.jobs, targets.size(), targetGrain,
+                [&](size_t begin, size_t end, size_t) { MoveTargets(game, dt, begin, end); });
+
+    ParallelFor(game.jobs, targets.size(), targetGrain, [&](size_t begin, size_t end, size_t c) {
+        TargetChunk &chunk = game.targetChunks[c];
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!targets.active[i])
+                continue;
+            float distanceToPlayer = Vector3Distance(TargetPosition(targets, i), (Vector3){0.0f, 0.1f, 0.0f});
+            bool arrived = game.navigation == NAVIGATION_FLOW_FIELD
+                               ? distanceToPlayer < arrivalDistance
+                               : targets.pathDistance[i] >= game.paths[targets.pathIndex[i]].stopDistance;
+            if (arrived && game.contactTimer >= contactTimeLimit)
+            {
+                targets.active[i] = false;
+                chunk.reachedEnd = true;
+            }
+
+            if (distanceToPlayer < (targets.radius[i] + 0.25f))
+            {
+                chunk.playerContacts++;
+            }
+        }
+    });
+
+    for (const TargetChunk &chunk : game.targetChunks)
+    {
+        if (chunk.reachedEnd)
+        {
+            game.gameOver = true;
+        }
+        for (int n = 0; n < chunk.playerContacts; n++)
+        {
+            game.inContact = true;
+            game.contactTimer += dt;
+        }
+    }
+
+    if (game.inContact)
+    {
+        game.contactTimer += dt;
+        if (game.contactTimer >= contactTimeLimit)
+        {
+            game.gameOver = true;
+            game.contactTimer = contactTimeLimit;
+        }
+    }
+    else
+    {
+        game.contactTimer = 0.0f;
+    }
+}
+
+void UpdateFences(Game &game)
+{
+    for (auto &fence : game.fences)
+    {
+        if (fence.fenceActive && fence.fenceContactTimer >= fence.fenceContactTimeLimit)
+        {
+            fence.fenceActive = false;
+        }
+    }
+}
+
+void UpdateTowers(Game &game, float dt)
+{
+    const float turretCooldownMax = 3.5f;
+
+    for (auto &tower : game.towers)
+    {
+        if (!tower.active)
+            continue;
+        tower.turretCooldown -= dt;
+        if (tower.turretCooldown <= 0.0f)
+        {
+            for (int turret = 0; turret < 2; turret++)
+            {
+                Vector3 turretPos = (turret == 0) ? tower.startPos : tower.endPos;
+                turretPos.y += 1.0f;
+                int nearest = FindNearestSpatialGrid(game.targetGrid, turretPos.x, turretPos.z, tower.turretRange,
+                                                     [&](int i) {
+                                                         if (!game.targets.active[i])
+                                                             return INFINITY;
+                                                         return Vector3Distance(turretPos,
+                                                                                TargetPosition(game.targets, i));
+                                                     });
+                if (nearest >= 0)
+                {
+                    Vector3 targetPos = TargetPosition(game.targets, nearest);
+                    FireMissile(game, turretPos, Vector3Normalize(Vector3Subtract(targetPos, turretPos)));
+                }
+            }
+            tower.turretCooldown = turretCooldownMax - (tower.upgradeLevel * 0.5f);
+        }
+    }
+}
+
+// Indexes every active fence under each grid cell its bounds cover. Fences
+// never move, so this only runs after the layout changes.
+void BuildFenceGrid(Game &game)
+{
+    SpatialGrid &grid = game.fenceGrid;
+    ClearSpatialGrid(grid);
+    for (size_t f = 0; f < game.fences.size(); f++)
+    {
+        const Fence &fence = game.fences[f];
+        if (!fence.fenceActive)
+            continue;
+        int minX = SpatialGridCell(grid, fence.bounds.min.x);
+        int maxX = SpatialGridCell(grid, fence.bounds.max.x);
+        int minZ = SpatialGridCell(grid, fence.bounds.min.z);
+        int maxZ = SpatialGridCell(grid, fence.bounds.max.z);
+        for (int cellX = minX; cellX <= maxX; cellX++)
+        {
+            for (int cellZ = minZ; cellZ <= maxZ; cellZ++)
+            {
+                InsertSpatialGridCell(grid, (int)f, cellX, cellZ);
+            }
+        }
+    }
+    FinishSpatialGrid(grid);
+    game.fenceGridVersion = game.layoutVersion;
+}
+
+// Covers the level's paths with a navigation grid, blocks the cells around
+// every tower post and fence with room for a target to pass, and solves the
+// field towards the player.
+void BuildFlowField(Game &game)
+{
+    const float cellSize = 1.0f;
+    const float margin = 5.0f;
+    const float clearance = 0.5f;
+    FlowField &field = game.flowField;
+
+    Vector3 low = (Vector3){0.0f, 0.0f, 0.0f};
+    Vector3 high = low;
+    for (const auto &waypoints : game.allWaypoints)
+    {
+        for (const Vector3 &point : waypoints)
+        {
+            low = Vector3Min(low, point);
+            high = Vector3Max(high, point);
+        }
+    }
+    ResetFlowField(field, low.x - margin, low.z - margin, high.x + margin, high.z + margin, cellSize);
+
+    for (const auto &tower : game.towers)
+    {
+        if (!tower.active)
+            continue;
+        float reach = (0.5f + tower.upgradeLevel * 0.05f) / 2 + clearance;
+        BlockFlowField(field, tower.startPos.x - reach, tower.startPos.z - reach, tower.startPos.x + reach,
+                       tower.startPos.z + reach);
+        BlockFlowField(field, tower.endPos.x - reach, tower.endPos.z - reach, tower.endPos.x + reach,
+                       tower.endPos.z + reach);
+    }
+    for (const auto &fence : game.fences)
+    {
+        if (!fence.fenceActive)
+            continue;
+        BlockFlowField(field, fence.bounds.min.x - clearance, fence.bounds.min.z - clearance,
+                       fence.bounds.max.x + clearance, fence.bounds.max.z + clearance);
+    }
+    SolveFlowField(field, 0.0f, 0.0f);
+    game.flowFieldVersion = game.layoutVersion;
+}
+
+void BuildTargetGrid(Game &game)
+{
+    ClearSpatialGrid(game.targetGrid);
+    game.maxTargetRadius = 0.0f;
+    const TargetPool &targets = game.targets;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        if (!targets.active[i])
+            continue;
+        InsertSpatialGrid(game.targetGrid, (int)i, targets.x[i], targets.z[i]);
+        game.maxTargetRadius = max(game.maxTargetRadius, targets.radius[i]);
+    }
+    FinishSpatialGrid(game.targetGrid);
+}
+
+void UpdateMissiles(Game &game, float dt)
+{
+    const float missileRadius = 0.1f;
+
+    size_t i = 0;
+    while (i < game.missiles.count)
+    {
+        Missile &missile = game.missiles.slots[i];
+        missile.position =
+            Vector3Add(missile.position, Vector3Scale(missile.direction, missile.speed * dt));
+        missile.lifetime -= dt;
+
+        // Hit the first target in vector order, as the full scan did.
+        int hit = -1;
+        QuerySpatialGrid(game.targetGrid, missile.position.x, missile.position.z,
+                         game.maxTargetRadius + missileRadius, [&](int t) {
+                             if (hit >= 0 && t >= hit)
+                                 return;
+                             if (!game.targets.active[t])
+                                 return;
+                             float distance = Vector3Distance(missile.position, TargetPosition(game.targets, t));
+                             if (distance < (game.targets.radius[t] + missileRadius))
+                             {
+                                 hit = t;
+                             }
+                         });
+        if (hit >= 0)
+        {
+            game.targets.active[hit] = false;
+            missile.active = false;
+            game.coins += 1;
+        }
+        if (missile.lifetime <= 0)
+        {
+            missile.active = false;
+        }
+
+        // The swapped-in missile has not been updated yet, so revisit slot i.
+        if (!missile.active)
+        {
+            RemoveMissile(game.missiles, i);
+            continue;
+        }
+        i++;
+    }
+
+    size_t oldFenceCount = game.fences.size();
+
+    RemoveInactiveTargets(game.targets);
+    RemoveSlotsIf(game.fences, [](const Fence &f) { return !f.fenceActive; });
+
+    size_t newFenceCount = game.fences.size();
+    game.fenceCount -= (oldFenceCount - newFenceCount);
+    if (newFenceCount != oldFenceCount)
+    {
+        game.layoutVersion++;
+    }
+}
+
+void UpdateGame(Game &game, float dt)
+{
+    // Due commands are applied even while paused, since one of them may resume the game.
+    if (game.replay != nullptr && !game.replay->finished)
+    {
+        ApplyReplayCommands(*game.replay, game);
+        // The recording stopped on this tick, so leave the state exactly as it was recorded.
+        if (game.replay->finished)
+            return;
+    }
+
+    if (game.pause || game.gameOver)
+        return;
+
+    TraceScope trace(game.profiler, "UpdateGame");
+    {
+        ProfileScope scope(game.profiler, PROFILE_UPDATE_WAVE);
+        UpdateWave(game, dt);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_SPAWN_ENEMIES);
+        SpawnEnemies(game, dt);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_UPDATE_TARGETS);
+        UpdateTargets(game, dt);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_UPDATE_FENCES);
+        UpdateFences(game);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_BUILD_TARGET_GRID);
+        BuildTargetGrid(game);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_UPDATE_TOWERS);
+        UpdateTowers(game, dt);
+    }
+    {
+        ProfileScope scope(game.profiler, PROFILE_UPDATE_MISSILES);
+        UpdateMissiles(game, dt);
+    }
+    game.tick++;
+}
+
+void StepGame(Game &game, float frameTime)
+{
+    const float tickTime = 1.0f / game.tickRate;
+
+    game.tickAccumulator += frameTime;
+    int ticks = 0;
+    while (game.tickAccumulator >= tickTime && ticks < game.maxTicksPerFrame)
+    {
+        UpdateGame(game, tickTime);
+        game.tickAccumulator -= tickTime;
+        ticks++;
+    }
+
+    // Too far behind to catch up: drop the backlog instead of spiralling.
+    if (game.tickAccumulator >= tickTime)
+    {
+        game.tickAccumulator = 0.0f;
+    }
+}
+
+void ResetGame(Game &game)
+{
+    game.coins = 1000;
+    game.gameOver = false;
+    game.pause = false;
+    game.contactTimer = 0.0f;
+    game.inContact = false;
+    game.spawnTimer = 0.0f;
+    game.enemiesSpawned = 0;
+    game.waveNumber = 1;
+    game.maxEnemies = game.waves.baseEnemies;
+    game.waveActive = true;
+    game.waveDelayTimer = 0.0f;
+    game.secondPathActive = false;
+    ClearTargets(game.targets);
+    game.missiles.count = 0;
+    ClearHandles(game.missiles.handles);
+    ClearSlots(game.towers);
+    ClearSlots(game.fences);
+    game.layoutVersion++;
+    game.towerCount = 0;
+    game.fenceCount = 0;
+    game.target.speed = game.waves.enemySpeed;
+    game.spawnDelay = game.waves.spawnDelay;
+    game.tickAccumulator = 0.0f;
+    game.tick = 0;
+}
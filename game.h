@@ -0,0 +1,250 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "flowfield.h"
+#include "handles.h"
+#include "jobs.h"
+#include "levels.h"
+#include "profiler.h"
+#include "raylib.h"
+#include "replay.h"
+#include "spatial.h"
+
+#include <vector>
+
+using namespace std;
+
+struct Target
+{
+    Vector3 position;
+    float radius;
+    bool active;
+    float speed;
+    float pathDistance;
+    int pathSegment;
+    bool stopped;
+    int pathIndex;
+    float lifeTimer = 0.0f;
+    float lifeTimeLimit = 3.0f;
+};
+
+// Structure-of-arrays storage for live targets; index i across every array is
+// one target. A target's place on its path is pathDistance, and x, y, z are
+// derived from it by MoveTargets.
+struct TargetPool
+{
+    vector<float> x;
+    vector<float> y;
+    vector<float> z;
+    vector<float> radius;
+    vector<float> speed;
+    vector<float> lifeTimer;
+    vector<float> lifeTimeLimit;
+    vector<float> pathDistance;
+    vector<int> pathSegment;
+    vector<int> pathIndex;
+    vector<unsigned char> active;
+    vector<unsigned char> stopped;
+    SlotTable handles;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+    bool empty() const
+    {
+        return x.empty();
+    }
+};
+
+// How close a target has to get to the end of its path, or to the player on
+// flow-field levels, to have arrived.
+const float arrivalDistance = 0.5f;
+
+// Arc-length table for one path of game.allWaypoints: segment s leaves
+// waypoint s along direction[s] at segmentStart[s] along the path. Targets
+// walk it up to stopDistance, just short of the last waypoint.
+struct Path
+{
+    vector<float> segmentStart;
+    vector<Vector3> direction;
+    float length = 0.0f;
+    float stopDistance = 0.0f;
+};
+
+struct Missile
+{
+    Vector3 position;
+    Vector3 direction;
+    bool active;
+    float speed;
+    float lifetime;
+};
+
+// Most missiles a MissilePool holds; saves asking for more are rejected.
+const int missileCapacity = 4096;
+
+// Fixed-capacity missile storage: live missiles are packed in slots[0, count)
+// and removed by swapping in the last one, so firing never allocates.
+struct MissilePool
+{
+    vector<Missile> slots;
+    size_t count = 0;
+    SlotTable handles;
+
+    size_t size() const
+    {
+        return count;
+    }
+};
+
+struct Tower
+{
+    Vector3 startPos;
+    Vector3 endPos;
+    bool active;
+    float turretCooldown;
+    float turretRange;
+    int upgradeLevel;
+};
+
+const float fenceWidth = 0.2f;
+
+struct Fence
+{
+    Vector3 startPos;
+    Vector3 endPos;
+    bool fenceActive;
+    float fenceTimer;
+    float fenceContactTimer;
+    float fenceContactTimeLimit = 3.0f;
+    bool fenceInContact;
+    // Set by PrepareFence when the fence is placed: direction is endPos -
+    // startPos, and bounds is the segment widened by half the fence width.
+    Vector3 direction;
+    float inverseLengthSquared;
+    BoundingBox bounds;
+};
+
+// What one chunk of the parallel passes in UpdateTargets did to shared state,
+// merged into the game in chunk order once every chunk has finished.
+struct TargetChunk
+{
+    int coins = 0;
+    bool freeTarget = false;
+    vector<int> fenceContacts;
+    vector<int> nearbyFences;
+    int playerContacts = 0;
+    bool reachedEnd = false;
+};
+
+enum CommandType
+{
+    COMMAND_FIRE,
+    COMMAND_BUY_TOWER,
+    COMMAND_BUY_FENCE,
+    COMMAND_PAUSE,
+    COMMAND_RESET,
+    COMMAND_SAVE,
+    COMMAND_LOAD
+};
+
+// A player action. The game thread owns the camera, so a shot carries the
+// pose it was fired from.
+struct Command
+{
+    CommandType type;
+    Vector3 position;
+    Vector3 direction;
+};
+
+struct Game
+{
+    vector<vector<Vector3>> allWaypoints;
+    // Built from allWaypoints by BuildPaths.
+    vector<Path> paths;
+    TargetPool targets;
+    MissilePool missiles;
+    SlotMap<Tower> towers;
+    SlotMap<Fence> fences;
+    // Indexes game.targets from BuildTargetGrid until UpdateMissiles compacts the vector.
+    SpatialGrid targetGrid;
+    // Indexes game.fences by the cells their bounds cover, rebuilt when layoutVersion changes.
+    SpatialGrid fenceGrid;
+    unsigned int fenceGridVersion = 0;
+    Navigation navigation = NAVIGATION_PATHS;
+    // Flow-field levels only: steers every target around the towers and
+    // fences, built by BuildFlowField whenever layoutVersion changes.
+    FlowField flowField;
+    unsigned int flowFieldVersion = 0;
+    float maxTargetRadius = 0.0f;
+    // The level being played: its wave curve and the hash replays identify it by.
+    WaveSchedule waves;
+    uint64_t levelHash = 0;
+    int waveNumber = 1;
+    int maxEnemies = 15;
+    int maxMissiles = missileCapacity;
+    float spawnTimer = 0.0f;
+    float spawnDelay = 1.0f;
+    int enemiesSpawned = 0;
+    float waveDelayTimer = 0.0f;
+    bool waveActive = true;
+    bool secondPathActive = false;
+    int coins = 1000;
+    float contactTimer = 0.0f;
+    bool inContact = false;
+    bool gameOver = false;
+    bool pause = false;
+    int towerCount = 0;
+    int fenceCount = 0;
+    bool canUpgrade = false;
+    unsigned int layoutVersion = 0;
+    // Last problem to show on the HUD; messageCount goes up with every new one.
+    const char *message = nullptr;
+    unsigned int messageCount = 0;
+    Target target;
+    float tickRate = 60.0f;
+    int maxTicksPerFrame = 5;
+    float tickAccumulator = 0.0f;
+    unsigned int tick = 0;
+    // Optional worker pool for the sim systems; null runs everything on the calling thread.
+    JobSystem *jobs = nullptr;
+    // Optional per-system timers, also null in the headless tools.
+    Profiler *profiler = nullptr;
+    // Optional input log being written, and recording being played back.
+    Recorder *recorder = nullptr;
+    Replay *replay = nullptr;
+    vector<TargetChunk> targetChunks;
+};
+Handle AddTarget(TargetPool &pool, const Target &target);
+Target GetTarget(const TargetPool &pool, size_t i);
+Vector3 TargetPosition(const TargetPool &pool, size_t i);
+void RemoveInactiveTargets(TargetPool &pool);
+void ClearTargets(TargetPool &pool);
+void BuildPaths(Game &game);
+Vector3 PathPosition(const vector<Vector3> &waypoints, const Path &path, float distance, int &segment);
+void MoveTargets(Game &game, float dt, size_t begin, size_t end);
+
+void InitializeGame(Game &game, const LevelSet &levels, int level);
+Handle AddMissile(MissilePool &pool, const Missile &missile);
+void RemoveMissile(MissilePool &pool, size_t i);
+void FireMissile(Game &game, Vector3 position, Vector3 direction);
+void BuyTower(Game &game);
+void PrepareFence(Fence &fence);
+void BuyFence(Game &game);
+void ShowMessage(Game &game, const char *message);
+void ApplyCommand(Game &game, const Command &command);
+void UpdateWave(Game &game, float dt);
+void SpawnEnemies(Game &game, float dt);
+void UpdateTargets(Game &game, float dt);
+void UpdateFences(Game &game);
+void BuildFenceGrid(Game &game);
+void BuildFlowField(Game &game);
+void BuildTargetGrid(Game &game);
+void UpdateTowers(Game &game, float dt);
+void UpdateMissiles(Game &game, float dt);
+void UpdateGame(Game &game, float dt);
+void StepGame(Game &game, float frameTime);
+void ResetGame(Game &game);
+
+#endif
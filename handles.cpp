@@ -0,0 +1,55 @@
+#include "handles.h"
+
+Handle CreateHandle(SlotTable &table)
+{
+    unsigned int slot;
+    if (!table.freeSlots.empty())
+    {
+        slot = table.freeSlots.back();
+        table.freeSlots.pop_back();
+    }
+    else
+    {
+        slot = (unsigned int)table.generation.size();
+        table.generation.push_back(1);
+        table.denseOf.push_back(0);
+    }
+    table.denseOf[slot] = (unsigned int)table.slotOf.size();
+    table.slotOf.push_back(slot);
+
+    Handle handle;
+    handle.index = slot;
+    handle.generation = table.generation[slot];
+    return handle;
+}
+
+void SwapRemoveHandle(SlotTable &table, size_t i)
+{
+    ReleaseSlot(table, table.slotOf[i]);
+    unsigned int last = table.slotOf.back();
+    table.slotOf.pop_back();
+    if (i < table.slotOf.size())
+    {
+        table.slotOf[i] = last;
+        table.denseOf[last] = (unsigned int)i;
+    }
+}
+
+void ReleaseSlot(SlotTable &table, unsigned int slot)
+{
+    table.generation[slot]++;
+    if (table.generation[slot] == 0)
+    {
+        table.generation[slot] = 1;
+    }
+    table.freeSlots.push_back(slot);
+}
+
+void ClearHandles(SlotTable &table)
+{
+    for (unsigned int slot : table.slotOf)
+    {
+        ReleaseSlot(table, slot);
+    }
+    table.slotOf.clear();
+}
@@ -0,0 +1,149 @@
+#ifndef HANDLES_H
+#define HANDLES_H
+
+#include <vector>
+
+using namespace std;
+
+// Stable reference to an entity. Generations start at 1, so a default Handle
+// never resolves; releasing a slot bumps its generation so old handles to it
+// stop resolving instead of dangling.
+struct Handle
+{
+    unsigned int index = 0;
+    unsigned int generation = 0;
+};
+
+// Maps handles to positions in a densely packed entity array and back. The
+// owner keeps it in step with every append, swap-remove or compaction of the
+// dense array.
+struct SlotTable
+{
+    vector<unsigned int> denseOf;
+    vector<unsigned int> generation;
+    vector<unsigned int> slotOf;
+    vector<unsigned int> freeSlots;
+};
+
+Handle CreateHandle(SlotTable &table);
+void SwapRemoveHandle(SlotTable &table, size_t i);
+void ReleaseSlot(SlotTable &table, unsigned int slot);
+void ClearHandles(SlotTable &table);
+
+inline Handle HandleAt(const SlotTable &table, size_t i)
+{
+    Handle handle;
+    handle.index = table.slotOf[i];
+    handle.generation = table.generation[handle.index];
+    return handle;
+}
+
+// Returns the dense index the handle refers to, or -1 once it has been removed.
+inline int ResolveHandle(const SlotTable &table, Handle handle)
+{
+    if (handle.index >= table.generation.size() || table.generation[handle.index] != handle.generation)
+        return -1;
+    return (int)table.denseOf[handle.index];
+}
+
+// Order-preserving removal of every dense index for which keep(i) is false,
+// matching a remove_if compaction of the dense array.
+template <typename Fn>
+void CompactHandles(SlotTable &table, Fn keep)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < table.slotOf.size(); i++)
+    {
+        unsigned int slot = table.slotOf[i];
+        if (keep(i))
+        {
+            table.slotOf[out] = slot;
+            table.denseOf[slot] = (unsigned int)out;
+            out++;
+        }
+        else
+        {
+            ReleaseSlot(table, slot);
+        }
+    }
+    table.slotOf.resize(out);
+}
+
+// Dense array of T addressable through generational handles.
+template <typename T>
+struct SlotMap
+{
+    vector<T> items;
+    SlotTable handles;
+
+    size_t size() const
+    {
+        return items.size();
+    }
+    bool empty() const
+    {
+        return items.empty();
+    }
+    T &operator[](size_t i)
+    {
+        return items[i];
+    }
+    const T &operator[](size_t i) const
+    {
+        return items[i];
+    }
+    typename vector<T>::iterator begin()
+    {
+        return items.begin();
+    }
+    typename vector<T>::iterator end()
+    {
+        return items.end();
+    }
+    typename vector<T>::const_iterator begin() const
+    {
+        return items.begin();
+    }
+    typename vector<T>::const_iterator end() const
+    {
+        return items.end();
+    }
+};
+
+template <typename T>
+Handle AddSlot(SlotMap<T> &map, const T &item)
+{
+    map.items.push_back(item);
+    return CreateHandle(map.handles);
+}
+
+template <typename T>
+T *GetSlot(SlotMap<T> &map, Handle handle)
+{
+    int i = ResolveHandle(map.handles, handle);
+    return i < 0 ? nullptr : &map.items[i];
+}
+
+template <typename T, typename Fn>
+void RemoveSlotsIf(SlotMap<T> &map, Fn remove)
+{
+    CompactHandles(map.handles, [&](size_t i) { return !remove(map.items[i]); });
+    size_t out = 0;
+    for (size_t i = 0; i < map.items.size(); i++)
+    {
+        if (!remove(map.items[i]))
+        {
+            map.items[out++] = map.items[i];
+        }
+    }
+    map.items.resize(out);
+}
+
+template <typename T>
+void ClearSlots(SlotMap<T> &map)
+{
+    map.items.clear();
+    ClearHandles(map.handles);
+}
+
+#endif
@@ -0,0 +1,180 @@
+#include "jobs.h"
+
+// The scheduler the calling thread works for and the index of its queue.
+static thread_local JobSystem *currentJobs = nullptr;
+static thread_local size_t currentQueue = 0;
+
+static size_t QueueIndex(const JobSystem &jobs)
+{
+    return currentJobs == &jobs ? currentQueue : 0;
+}
+
+static void PushTask(JobSystem &jobs, const TaskHandle &task)
+{
+    TaskQueue &queue = *jobs.queues[QueueIndex(jobs)];
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    jobs.queuedTasks++;
+    {
+        // Taking the lock orders this against a worker deciding to sleep.
+        lock_guard<mutex> guard(jobs.sleepLock);
+    }
+    jobs.wake.notify_one();
+}
+
+static TaskHandle PopTask(JobSystem &jobs)
+{
+    TaskHandle task;
+    if (jobs.queuedTasks == 0)
+        return task;
+
+    size_t self = QueueIndex(jobs);
+    for (size_t i = 0; i < jobs.queues.size() && !task; i++)
+    {
+        TaskQueue &queue = *jobs.queues[(self + i) % jobs.queues.size()];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty())
+            continue;
+        if (i == 0)
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        jobs.queuedTasks--;
+    }
+    return task;
+}
+
+static void RunTask(JobSystem &jobs, const TaskHandle &task)
+{
+    {
+        TraceScope scope(jobs.profiler, "Task");
+        task->run();
+    }
+
+    vector<TaskHandle> continuations;
+    {
+        lock_guard<mutex> guard(task->lock);
+        task->done = true;
+        continuations.swap(task->continuations);
+    }
+    for (const TaskHandle &next : continuations)
+    {
+        if (--next->blockers == 0)
+        {
+            PushTask(jobs, next);
+        }
+    }
+}
+
+static void WorkerLoop(JobSystem &jobs, size_t queue)
+{
+    currentJobs = &jobs;
+    currentQueue = queue;
+    while (true)
+    {
+        TaskHandle task = PopTask(jobs);
+        if (task)
+        {
+            RunTask(jobs, task);
+            continue;
+        }
+
+        unique_lock<mutex> guard(jobs.sleepLock);
+        jobs.wake.wait(guard, [&] { return jobs.quit || jobs.queuedTasks > 0; });
+        if (jobs.quit)
+            return;
+    }
+}
+
+void StartJobSystem(JobSystem &jobs, int workerCount)
+{
+    jobs.quit = false;
+    jobs.queues.clear();
+    for (int i = 0; i <= workerCount; i++)
+    {
+        jobs.queues.emplace_back(new TaskQueue());
+    }
+    for (int i = 0; i < workerCount; i++)
+    {
+        jobs.workers.emplace_back(WorkerLoop, ref(jobs), (size_t)i + 1);
+    }
+}
+
+void StopJobSystem(JobSystem &jobs)
+{
+    {
+        lock_guard<mutex> guard(jobs.sleepLock);
+        jobs.quit = true;
+    }
+    jobs.wake.notify_all();
+    for (auto &worker : jobs.workers)
+    {
+        worker.join();
+    }
+    jobs.workers.clear();
+}
+
+TaskHandle CreateTask(function<void()> run)
+{
+    TaskHandle task = make_shared<Task>();
+    task->run = move(run);
+    return task;
+}
+
+// Must be called before after is submitted.
+void AddDependency(const TaskHandle &before, const TaskHandle &after)
+{
+    lock_guard<mutex> guard(before->lock);
+    if (before->done)
+        return;
+    after->blockers++;
+    before->continuations.push_back(after);
+}
+
+void SubmitTask(JobSystem &jobs, const TaskHandle &task)
+{
+    if (--task->blockers == 0)
+    {
+        PushTask(jobs, task);
+    }
+}
+
+// Runs other tasks, the awaited one included, until it has finished.
+void WaitTask(JobSystem &jobs, const TaskHandle &task)
+{
+    while (!task->done)
+    {
+        TaskHandle next = PopTask(jobs);
+        if (next)
+        {
+            RunTask(jobs, next);
+        }
+        else
+        {
+            this_thread::yield();
+        }
+    }
+}
+
+void RunJobs(JobSystem &jobs, size_t count, const function<void(size_t)> &job)
+{
+    // One task per job, pushed on this thread's queue for idle workers to
+    // steal, and an empty task that finishes once they all have.
+    TaskHandle finished = CreateTask([] {});
+    for (size_t i = 0; i < count; i++)
+    {
+        TaskHandle task = CreateTask([&job, i] { job(i); });
+        AddDependency(task, finished);
+        SubmitTask(jobs, task);
+    }
+    SubmitTask(jobs, finished);
+    WaitTask(jobs, finished);
+}
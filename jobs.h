@@ -0,0 +1,82 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Unit of work for the scheduler. A task becomes runnable once it has been
+// submitted and every task it depends on has finished.
+struct Task
+{
+    function<void()> run;
+    atomic<int> blockers{1};
+    atomic<bool> done{false};
+    mutex lock;
+    vector<shared_ptr<Task>> continuations;
+};
+
+typedef shared_ptr<Task> TaskHandle;
+
+// Each thread pushes and pops runnable tasks at the back of its own deque;
+// a thread that runs dry steals from the front of the others'.
+struct TaskQueue
+{
+    mutex lock;
+    deque<shared_ptr<Task>> tasks;
+};
+
+// Work-stealing scheduler. Queue 0 belongs to whichever threads are not
+// workers, so the main thread runs tasks while it waits on them.
+struct JobSystem
+{
+    vector<thread> workers;
+    vector<unique_ptr<TaskQueue>> queues;
+    mutex sleepLock;
+    condition_variable wake;
+    atomic<int> queuedTasks{0};
+    bool quit = false;
+    // Optional; while it is tracing every task shows up as a span on the thread that ran it.
+    Profiler *profiler = nullptr;
+};
+
+void StartJobSystem(JobSystem &jobs, int workerCount);
+void StopJobSystem(JobSystem &jobs);
+TaskHandle CreateTask(function<void()> run);
+void AddDependency(const TaskHandle &before, const TaskHandle &after);
+void SubmitTask(JobSystem &jobs, const TaskHandle &task);
+void WaitTask(JobSystem &jobs, const TaskHandle &task);
+void RunJobs(JobSystem &jobs, size_t count, const function<void(size_t)> &job);
+
+// Splits [0, count) into ranges of grain items and calls fn(begin, end, chunk)
+// for each. Chunk boundaries depend only on count and grain, never on the
+// number of threads, so per-chunk results merged in chunk order are
+// deterministic. Runs inline when there is no job system.
+template <typename Fn>
+void ParallelFor(JobSystem *jobs, size_t count, size_t grain, Fn fn)
+{
+    size_t chunks = (count + grain - 1) / grain;
+    if (jobs == nullptr || jobs->workers.empty() || chunks <= 1)
+    {
+        for (size_t chunk = 0; chunk < chunks; chunk++)
+        {
+            fn(chunk * grain, min(count, (chunk + 1) * grain), chunk);
+        }
+        return;
+    }
+
+    function<void(size_t)> job = [&](size_t chunk) { fn(chunk * grain, min(count, (chunk + 1) * grain), chunk); };
+    RunJobs(*jobs, chunks, job);
+}
+
+#endif
@@ -0,0 +1,416 @@
+#include "levels.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// The text config is a list of levels, one setting per line, # starts a comment:
+//   level <name>
+//   path <x y z> <x y z> ...          one line per path, at least two points
+//   enemies <base> <per wave>
+//   spawn_delay <start> <step> <min>
+//   speed <start> <step> <max>
+//   wave_delay <seconds>
+//   second_path <wave> <extra enemies>
+//   navigation <paths | flow_field>
+// Settings a level leaves out keep the WaveSchedule defaults.
+//
+// The cache holds a CacheHeader and then the LevelSet arrays in memory
+// layout. It is keyed by a hash of the config text, so any edit to the config
+// recompiles it, and the header records the struct sizes and byte order so a
+// cache from a different build is recompiled instead of misread.
+static const char cacheMagic[4] = {'K', 'S', 'L', 'V'};
+const uint32_t cacheVersion = 2;
+const uint32_t cacheByteOrder = 0x01020304;
+
+struct CacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t levelSize;
+    uint64_t sourceHash;
+    uint64_t levelCount;
+    uint64_t pathCount;
+    uint64_t pointCount;
+    uint64_t nameCount;
+};
+
+// 64-bit FNV-1a; pass the previous result as hash to continue over more data.
+uint64_t HashBytes(const void *data, size_t size, uint64_t hash)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static bool ReadFile(const char *path, vector<char> &bytes)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    bytes.clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    return !failed;
+}
+
+// Checks that every index in the set stays inside its arrays, which the
+// parser guarantees and a damaged cache may not.
+static bool ValidLevels(const LevelSet &set)
+{
+    if (set.levels.empty() || set.pathStart.empty() || set.pathStart[0] != 0 ||
+        set.pathStart.back() != set.points.size())
+        return false;
+    size_t pathCount = set.pathStart.size() - 1;
+    for (size_t p = 0; p < pathCount; p++)
+    {
+        if (set.pathStart[p + 1] < set.pathStart[p] + 2)
+            return false;
+    }
+    for (const LevelInfo &info : set.levels)
+    {
+        if (info.pathCount == 0 || (uint32_t)info.navigation > NAVIGATION_FLOW_FIELD || info.firstPath > pathCount ||
+            info.pathCount > pathCount - info.firstPath || info.nameOffset > set.names.size() ||
+            info.nameLength > set.names.size() - info.nameOffset)
+            return false;
+    }
+    return true;
+}
+
+static bool ReadCache(LevelSet &set, const vector<char> &bytes, uint64_t sourceHash)
+{
+    CacheHeader header;
+    if (bytes.size() < sizeof(header))
+        return false;
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion ||
+        header.byteOrder != cacheByteOrder || header.levelSize != sizeof(LevelInfo) ||
+        header.sourceHash != sourceHash)
+        return false;
+
+    // Compared one array at a time so a garbage count cannot overflow the total.
+    size_t remaining = bytes.size() - sizeof(header);
+    if (header.levelCount > remaining / sizeof(LevelInfo))
+        return false;
+    remaining -= header.levelCount * sizeof(LevelInfo);
+    if (header.pathCount > remaining / sizeof(uint32_t))
+        return false;
+    remaining -= header.pathCount * sizeof(uint32_t);
+    if (header.pointCount > remaining / sizeof(Vector3))
+        return false;
+    remaining -= header.pointCount * sizeof(Vector3);
+    if (header.nameCount != remaining)
+        return false;
+
+    const char *data = bytes.data() + sizeof(header);
+    set.levels.resize((size_t)header.levelCount);
+    set.pathStart.resize((size_t)header.pathCount);
+    set.points.resize((size_t)header.pointCount);
+    set.names.resize((size_t)header.nameCount);
+    memcpy(set.levels.data(), data, set.levels.size() * sizeof(LevelInfo));
+    data += set.levels.size() * sizeof(LevelInfo);
+    memcpy(set.pathStart.data(), data, set.pathStart.size() * sizeof(uint32_t));
+    data += set.pathStart.size() * sizeof(uint32_t);
+    memcpy(set.points.data(), data, set.points.size() * sizeof(Vector3));
+    data += set.points.size() * sizeof(Vector3);
+    memcpy(set.names.data(), data, set.names.size());
+    return ValidLevels(set);
+}
+
+static void WriteCache(const LevelSet &set, const char *path, uint64_t sourceHash)
+{
+    CacheHeader header;
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.byteOrder = cacheByteOrder;
+    header.levelSize = sizeof(LevelInfo);
+    header.sourceHash = sourceHash;
+    header.levelCount = set.levels.size();
+    header.pathCount = set.pathStart.size();
+    header.pointCount = set.points.size();
+    header.nameCount = set.names.size();
+
+    // Written under a temporary name and renamed, so a crash never leaves a
+    // half-written cache that a later launch has to reject.
+    string temporary = string(path) + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file)
+        return;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(set.levels.data(), sizeof(LevelInfo), set.levels.size(), file);
+    fwrite(set.pathStart.data(), sizeof(uint32_t), set.pathStart.size(), file);
+    fwrite(set.points.data(), sizeof(Vector3), set.points.size(), file);
+    fwrite(set.names.data(), 1, set.names.size(), file);
+    bool written = ferror(file) == 0;
+    if (fclose(file) != 0 || !written)
+    {
+        remove(temporary.c_str());
+        return;
+    }
+    remove(path);
+    rename(temporary.c_str(), path);
+}
+
+static bool ParseNumbers(const vector<string> &words, float *values, size_t count)
+{
+    if (words.size() != count + 1)
+        return false;
+    for (size_t i = 0; i < count; i++)
+    {
+        char *end;
+        values[i] = strtof(words[i + 1].c_str(), &end);
+        if (*end != '\0' || values[i] < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+static bool ParseCounts(const vector<string> &words, int *values, size_t count)
+{
+    if (words.size() != count + 1)
+        return false;
+    for (size_t i = 0; i < count; i++)
+    {
+        char *end;
+        long value = strtol(words[i + 1].c_str(), &end, 10);
+        if (*end != '\0' || value < 0 || value > 1000000)
+            return false;
+        values[i] = (int)value;
+    }
+    return true;
+}
+
+// Appends the level being parsed to the set and hashes what it compiled to,
+// which is what replays use to tell levels apart.
+static void FinishLevel(LevelSet &set, LevelInfo &info, const string &name)
+{
+    info.nameOffset = (uint32_t)set.names.size();
+    info.nameLength = (uint32_t)name.size();
+    set.names.insert(set.names.end(), name.begin(), name.end());
+
+    uint64_t hash = HashBytes(name.data(), name.size());
+    hash = HashBytes(&info.waves, sizeof(info.waves), hash);
+    // Path levels keep the hash they had before levels could pick a navigation.
+    if (info.navigation != NAVIGATION_PATHS)
+        hash = HashBytes(&info.navigation, sizeof(info.navigation), hash);
+    for (uint32_t p = info.firstPath; p < info.firstPath + info.pathCount; p++)
+    {
+        uint32_t count = set.pathStart[p + 1] - set.pathStart[p];
+        hash = HashBytes(&count, sizeof(count), hash);
+        hash = HashBytes(&set.points[set.pathStart[p]], count * sizeof(Vector3), hash);
+    }
+    info.hash = hash;
+    set.levels.push_back(info);
+}
+
+bool ParseLevels(LevelSet &set, const char *text, size_t size, string &error)
+{
+    set.levels.clear();
+    set.pathStart.assign(1, 0);
+    set.points.clear();
+    set.names.clear();
+
+    LevelInfo info = {};
+    string name;
+    bool inLevel = false;
+    int lineNumber = 0;
+    const char *end = text + size;
+    for (const char *line = text; line < end;)
+    {
+        const char *lineEnd = (const char *)memchr(line, '\n', end - line);
+        if (!lineEnd)
+            lineEnd = end;
+        lineNumber++;
+
+        vector<string> words;
+        for (const char *c = line; c < lineEnd && *c != '#';)
+        {
+            if (*c == ' ' || *c == '\t' || *c == '\r')
+            {
+                c++;
+                continue;
+            }
+            const char *wordEnd = c;
+            while (wordEnd < lineEnd && *wordEnd != ' ' && *wordEnd != '\t' && *wordEnd != '\r' && *wordEnd != '#')
+                wordEnd++;
+            words.push_back(string(c, wordEnd));
+            c = wordEnd;
+        }
+        line = lineEnd + 1;
+        if (words.empty())
+            continue;
+
+        const string &key = words[0];
+        bool valid = true;
+        char message[128];
+        snprintf(message, sizeof(message), "line %d: bad %s", lineNumber, key.c_str());
+        if (key == "level")
+        {
+            if (inLevel)
+                FinishLevel(set, info, name);
+            valid = words.size() == 2 && FindLevel(set, words[1].c_str()) < 0;
+            info = LevelInfo();
+            info.firstPath = (uint32_t)set.pathStart.size() - 1;
+            name = words.back();
+            inLevel = true;
+        }
+        else if (!inLevel)
+        {
+            snprintf(message, sizeof(message), "line %d: %s before the first level", lineNumber, key.c_str());
+            valid = false;
+        }
+        else if (key == "path")
+        {
+            size_t count = (words.size() - 1) / 3;
+            vector<float> values(count * 3);
+            for (size_t i = 0; i < values.size() && valid; i++)
+            {
+                char *numberEnd;
+                values[i] = strtof(words[i + 1].c_str(), &numberEnd);
+                valid = *numberEnd == '\0';
+            }
+            valid = valid && count >= 2 && words.size() == count * 3 + 1;
+            for (size_t i = 0; i < count && valid; i++)
+            {
+                set.points.push_back((Vector3){values[i * 3], values[i * 3 + 1], values[i * 3 + 2]});
+            }
+            if (valid)
+            {
+                set.pathStart.push_back((uint32_t)set.points.size());
+                info.pathCount++;
+            }
+        }
+        else if (key == "enemies")
+        {
+            int values[2] = {};
+            valid = ParseCounts(words, values, 2) && values[0] > 0;
+            info.waves.baseEnemies = values[0];
+            info.waves.enemiesPerWave = values[1];
+        }
+        else if (key == "spawn_delay")
+        {
+            float values[3] = {};
+            valid = ParseNumbers(words, values, 3) && values[2] > 0.0f;
+            info.waves.spawnDelay = values[0];
+            info.waves.spawnDelayStep = values[1];
+            info.waves.minSpawnDelay = values[2];
+        }
+        else if (key == "speed")
+        {
+            float values[3] = {};
+            valid = ParseNumbers(words, values, 3);
+            info.waves.enemySpeed = values[0];
+            info.waves.enemySpeedStep = values[1];
+            info.waves.maxEnemySpeed = values[2];
+        }
+        else if (key == "wave_delay")
+        {
+            valid = ParseNumbers(words, &info.waves.waveDelay, 1);
+        }
+        else if (key == "second_path")
+        {
+            int values[2] = {};
+            valid = ParseCounts(words, values, 2);
+            info.waves.secondPathWave = values[0];
+            info.waves.secondPathEnemies = values[1];
+        }
+        else if (key == "navigation")
+        {
+            valid = words.size() == 2 && (words[1] == "paths" || words[1] == "flow_field");
+            info.navigation = words.back() == "flow_field" ? NAVIGATION_FLOW_FIELD : NAVIGATION_PATHS;
+        }
+        else
+        {
+            snprintf(message, sizeof(message), "line %d: unknown setting %s", lineNumber, key.c_str());
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            error = message;
+            return false;
+        }
+    }
+    if (inLevel)
+        FinishLevel(set, info, name);
+
+    if (set.levels.empty())
+    {
+        error = "no levels";
+        return false;
+    }
+    for (const LevelInfo &level : set.levels)
+    {
+        if (level.pathCount == 0)
+        {
+            error = "level " + string(&set.names[level.nameOffset], level.nameLength) + " has no path";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Loads the level config at path, from the compiled cache at cachePath when
+// that was built from the same text, otherwise by parsing it and rewriting the
+// cache. A cache that cannot be written only costs the next launch a parse.
+bool LoadLevels(LevelSet &set, const char *path, const char *cachePath, string &error)
+{
+    vector<char> text;
+    if (!ReadFile(path, text))
+    {
+        error = string("cannot read ") + path;
+        return false;
+    }
+    uint64_t sourceHash = HashBytes(text.data(), text.size());
+
+    vector<char> cache;
+    if (ReadFile(cachePath, cache) && ReadCache(set, cache, sourceHash))
+        return true;
+
+    if (!ParseLevels(set, text.data(), text.size(), error))
+    {
+        error = string(path) + ": " + error;
+        return false;
+    }
+    WriteCache(set, cachePath, sourceHash);
+    return true;
+}
+
+string LevelName(const LevelSet &set, int level)
+{
+    const LevelInfo &info = set.levels[level];
+    return string(set.names.data() + info.nameOffset, info.nameLength);
+}
+
+int FindLevel(const LevelSet &set, const char *name)
+{
+    size_t length = strlen(name);
+    for (size_t i = 0; i < set.levels.size(); i++)
+    {
+        const LevelInfo &info = set.levels[i];
+        if (info.nameLength == length && memcmp(set.names.data() + info.nameOffset, name, length) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+int FindLevelByHash(const LevelSet &set, uint64_t hash)
+{
+    for (size_t i = 0; i < set.levels.size(); i++)
+    {
+        if (set.levels[i].hash == hash)
+            return (int)i;
+    }
+    return -1;
+}
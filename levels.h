@@ -0,0 +1,73 @@
+#ifndef LEVELS_H
+#define LEVELS_H
+
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const char *const levelsPath = "resources/levels.txt";
+const char *const levelsCachePath = "kingshot-levels.cache";
+
+// How a level's waves ramp up. Wave n spawns baseEnemies + (n - 1) *
+// enemiesPerWave enemies, plus secondPathEnemies once the second path opens.
+struct WaveSchedule
+{
+    int baseEnemies = 15;
+    int enemiesPerWave = 5;
+    float waveDelay = 5.0f;
+    float spawnDelay = 1.0f;
+    float spawnDelayStep = 0.1f;
+    float minSpawnDelay = 0.3f;
+    float enemySpeed = 3.0f;
+    float enemySpeedStep = 0.2f;
+    float maxEnemySpeed = 7.0f;
+    int secondPathWave = 10;
+    int secondPathEnemies = 10;
+};
+
+// How a level's enemies find the player: walking their paths, or following a
+// flow field around the towers and fences, in which case each path only
+// supplies a spawn point and widens the navigation grid.
+enum Navigation
+{
+    NAVIGATION_PATHS,
+    NAVIGATION_FLOW_FIELD
+};
+
+// One level of a LevelSet: its paths are entries [firstPath, firstPath +
+// pathCount) of pathStart, and its name is nameLength bytes at nameOffset.
+struct LevelInfo
+{
+    uint64_t hash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t firstPath;
+    uint32_t pathCount;
+    Navigation navigation;
+    WaveSchedule waves;
+};
+
+// Every level in the config, stored as flat arrays so the binary cache is
+// just these arrays back to back. Path p runs over points[pathStart[p]] to
+// points[pathStart[p + 1] - 1].
+struct LevelSet
+{
+    vector<LevelInfo> levels;
+    vector<uint32_t> pathStart;
+    vector<Vector3> points;
+    vector<char> names;
+};
+
+uint64_t HashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ull);
+bool ParseLevels(LevelSet &set, const char *text, size_t size, string &error);
+bool LoadLevels(LevelSet &set, const char *path, const char *cachePath, string &error);
+string LevelName(const LevelSet &set, int level);
+int FindLevel(const LevelSet &set, const char *name);
+int FindLevelByHash(const LevelSet &set, uint64_t hash);
+
+#endif
@@ -0,0 +1,197 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+ProfileScope::ProfileScope(Profiler *profiler, ProfileStage stage) : profiler(profiler), stage(stage)
+{
+    if (profiler != nullptr)
+    {
+        start = chrono::steady_clock::now();
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (profiler != nullptr)
+    {
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        chrono::duration<float, milli> elapsed = end - start;
+        RecordProfileSample(*profiler, stage, elapsed.count());
+        RecordTraceEvent(profiler->tracer, ProfileStageName(stage), start, end);
+    }
+}
+
+TraceScope::TraceScope(Profiler *profiler, const char *name) : profiler(profiler), name(name)
+{
+    if (profiler != nullptr && profiler->tracer.active)
+    {
+        start = chrono::steady_clock::now();
+    }
+    else
+    {
+        this->profiler = nullptr;
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (profiler != nullptr)
+    {
+        RecordTraceEvent(profiler->tracer, name, start, chrono::steady_clock::now());
+    }
+}
+
+const char *ProfileStageName(ProfileStage stage)
+{
+    static const char *names[PROFILE_STAGE_COUNT] = {"HandleInput",     "UpdateWave",   "SpawnEnemies",
+                                                     "UpdateTargets",   "UpdateFences", "BuildTargetGrid",
+                                                     "UpdateTowers",    "UpdateMissiles", "RenderGame",
+                                                     "EndDrawing"};
+    return names[stage];
+}
+
+void RecordProfileSample(Profiler &profiler, ProfileStage stage, float milliseconds)
+{
+    lock_guard<mutex> guard(profiler.lock);
+    ProfileRing &ring = profiler.rings[stage];
+    ring.samples[ring.next] = milliseconds;
+    ring.next = (ring.next + 1) % profileHistory;
+    ring.count = min(ring.count + 1, profileHistory);
+}
+
+ProfileStats GetProfileStats(Profiler &profiler, ProfileStage stage)
+{
+    float samples[profileHistory];
+    int count;
+    {
+        lock_guard<mutex> guard(profiler.lock);
+        const ProfileRing &ring = profiler.rings[stage];
+        count = ring.count;
+        copy(ring.samples, ring.samples + count, samples);
+    }
+
+    ProfileStats stats;
+    stats.count = count;
+    if (count == 0)
+        return stats;
+
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        sum += samples[i];
+    }
+    stats.mean = sum / count;
+
+    // Nearest-rank percentile: the smallest sample with at least 99% of the others at or below it.
+    int rank = max(0, (int)ceilf(0.99f * count) - 1);
+    nth_element(samples, samples + rank, samples + count);
+    stats.p99 = samples[rank];
+    stats.max = *max_element(samples + rank, samples + count);
+    return stats;
+}
+
+const size_t traceFlushEvents = 4096;
+
+// Small stable ids for the "tid" field, handed out on first use.
+static unsigned int TraceThreadId()
+{
+    static atomic<unsigned int> nextId{1};
+    static thread_local unsigned int id = 0;
+    if (id == 0)
+    {
+        id = nextId++;
+    }
+    return id;
+}
+
+// Wakes every flushInterval, or earlier once enough events have piled up, so
+// recording threads rarely have to signal it.
+static void WriteTraceEvents(Tracer &tracer)
+{
+    const chrono::milliseconds flushInterval(100);
+
+    vector<TraceEvent> events;
+    unique_lock<mutex> guard(tracer.lock);
+    bool first = true;
+    while (true)
+    {
+        tracer.wake.wait_for(guard, flushInterval,
+                             [&] { return tracer.quit || tracer.pending.size() >= traceFlushEvents; });
+        events.swap(tracer.pending);
+        bool quit = tracer.quit;
+        guard.unlock();
+
+        for (const TraceEvent &event : events)
+        {
+            fprintf(tracer.file,
+                    "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    first ? "" : ",", event.name, event.thread, event.start, event.duration);
+            first = false;
+        }
+        events.clear();
+
+        guard.lock();
+        if (quit && tracer.pending.empty())
+            return;
+    }
+}
+
+bool StartTrace(Tracer &tracer, const char *path)
+{
+    if (tracer.active)
+        return true;
+    tracer.file = fopen(path, "w");
+    if (!tracer.file)
+        return false;
+    fprintf(tracer.file, "{\"traceEvents\": [");
+
+    tracer.pending.clear();
+    tracer.quit = false;
+    tracer.epoch = chrono::steady_clock::now();
+    tracer.writer = thread(WriteTraceEvents, ref(tracer));
+    tracer.active = true;
+    return true;
+}
+
+// Events still being recorded by other threads when tracing stops are dropped.
+void StopTrace(Tracer &tracer)
+{
+    if (!tracer.active)
+        return;
+    tracer.active = false;
+    {
+        lock_guard<mutex> guard(tracer.lock);
+        tracer.quit = true;
+    }
+    tracer.wake.notify_one();
+    tracer.writer.join();
+
+    fprintf(tracer.file, "\n]}\n");
+    fclose(tracer.file);
+    tracer.file = nullptr;
+}
+
+void RecordTraceEvent(Tracer &tracer, const char *name, chrono::steady_clock::time_point start,
+                      chrono::steady_clock::time_point end)
+{
+    if (!tracer.active)
+        return;
+
+    TraceEvent event;
+    event.name = name;
+    event.thread = TraceThreadId();
+    event.start = chrono::duration<double, micro>(start - tracer.epoch).count();
+    event.duration = chrono::duration<double, micro>(end - start).count();
+    bool flush;
+    {
+        lock_guard<mutex> guard(tracer.lock);
+        event.start = max(event.start, 0.0);
+        tracer.pending.push_back(event);
+        flush = tracer.pending.size() == traceFlushEvents;
+    }
+    if (flush)
+    {
+        tracer.wake.notify_one();
+    }
+}
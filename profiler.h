@@ -0,0 +1,112 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+enum ProfileStage
+{
+    PROFILE_HANDLE_INPUT,
+    PROFILE_UPDATE_WAVE,
+    PROFILE_SPAWN_ENEMIES,
+    PROFILE_UPDATE_TARGETS,
+    PROFILE_UPDATE_FENCES,
+    PROFILE_BUILD_TARGET_GRID,
+    PROFILE_UPDATE_TOWERS,
+    PROFILE_UPDATE_MISSILES,
+    PROFILE_RENDER_GAME,
+    PROFILE_END_DRAWING,
+    PROFILE_STAGE_COUNT
+};
+
+const int profileHistory = 256;
+
+// Last profileHistory durations of one stage, in milliseconds.
+struct ProfileRing
+{
+    float samples[profileHistory];
+    int next = 0;
+    int count = 0;
+};
+
+struct ProfileStats
+{
+    float mean = 0.0f;
+    float max = 0.0f;
+    float p99 = 0.0f;
+    int count = 0;
+};
+
+// One complete ("ph": "X") Chrome trace event, times in microseconds since
+// the trace started.
+struct TraceEvent
+{
+    const char *name;
+    unsigned int thread;
+    double start;
+    double duration;
+};
+
+// Collects trace events from any thread while active. A background thread
+// drains them to the file, so recording only appends to a vector.
+struct Tracer
+{
+    atomic<bool> active{false};
+    mutex lock;
+    condition_variable wake;
+    vector<TraceEvent> pending;
+    thread writer;
+    FILE *file = nullptr;
+    bool quit = false;
+    chrono::steady_clock::time_point epoch;
+};
+
+// Stages are timed on both the main and the sim thread, so every access goes
+// through the lock.
+struct Profiler
+{
+    mutex lock;
+    ProfileRing rings[PROFILE_STAGE_COUNT];
+    Tracer tracer;
+};
+
+// Times its own lifetime into one stage and, while tracing, the trace; does
+// nothing without a profiler.
+struct ProfileScope
+{
+    Profiler *profiler;
+    ProfileStage stage;
+    chrono::steady_clock::time_point start;
+
+    ProfileScope(Profiler *profiler, ProfileStage stage);
+    ~ProfileScope();
+};
+
+// Trace-only counterpart of ProfileScope for spans that have no stage, such as
+// whole frames and worker tasks. name must outlive the trace.
+struct TraceScope
+{
+    Profiler *profiler;
+    const char *name;
+    chrono::steady_clock::time_point start;
+
+    TraceScope(Profiler *profiler, const char *name);
+    ~TraceScope();
+};
+
+const char *ProfileStageName(ProfileStage stage);
+void RecordProfileSample(Profiler &profiler, ProfileStage stage, float milliseconds);
+ProfileStats GetProfileStats(Profiler &profiler, ProfileStage stage);
+bool StartTrace(Tracer &tracer, const char *path);
+void StopTrace(Tracer &tracer);
+void RecordTraceEvent(Tracer &tracer, const char *name, chrono::steady_clock::time_point start,
+                      chrono::steady_clock::time_point end);
+
+#endif
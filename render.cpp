@@ -0,0 +1,608 @@
+#include "render.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void LoadRenderer(Renderer &renderer)
+{
+    renderer.moonSoilTexture = LoadTexture("resources/moon_soil.png");
+    renderer.moonMaterial = LoadMaterialDefault();
+    renderer.moonMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = renderer.moonSoilTexture;
+
+    renderer.plane = LoadModelFromMesh(GenMeshPlane(1.0f, 1.0f, 1, 1));
+    renderer.plane.materials[0] = renderer.moonMaterial;
+
+    renderer.instancingShader = LoadShader("resources/shaders/instancing.vs", "resources/shaders/instancing.fs");
+    renderer.instancingShader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(renderer.instancingShader, "mvp");
+    renderer.instancingShader.locs[SHADER_LOC_VERTEX_INSTANCE_TX] =
+        GetShaderLocationAttrib(renderer.instancingShader, "instanceTransform");
+
+    // LOD 0 matches the tessellation DrawSphere and DrawSphereWires(..., 10, 10, ...) used.
+    const int sphereRings[sphereLodCount] = {16, 8, 5};
+    const int sphereWireRings[sphereLodCount] = {10, 6, 4};
+    for (int lod = 0; lod < sphereLodCount; lod++)
+    {
+        renderer.sphereMeshes[lod] = GenMeshSphere(1.0f, sphereRings[lod], sphereRings[lod]);
+        renderer.sphereWireMeshes[lod] = GenMeshSphere(1.0f, sphereWireRings[lod], sphereWireRings[lod]);
+    }
+    renderer.impostorMesh = GenMeshPoly(8, 1.0f);
+    renderer.cubeMesh = GenMeshCube(1.0f, 1.0f, 1.0f);
+
+    renderer.targetMaterial = LoadMaterialDefault();
+    renderer.targetMaterial.shader = renderer.instancingShader;
+    renderer.targetMaterial.maps[MATERIAL_MAP_DIFFUSE].color = RED;
+    renderer.targetWireMaterial = LoadMaterialDefault();
+    renderer.targetWireMaterial.shader = renderer.instancingShader;
+    renderer.targetWireMaterial.maps[MATERIAL_MAP_DIFFUSE].color = BLACK;
+    renderer.missileMaterial = LoadMaterialDefault();
+    renderer.missileMaterial.shader = renderer.instancingShader;
+    renderer.missileMaterial.maps[MATERIAL_MAP_DIFFUSE].color = RED;
+
+    renderer.pathMaterial = LoadMaterialDefault();
+    renderer.pathMaterial.maps[MATERIAL_MAP_DIFFUSE].color = VIOLET;
+    renderer.pathMeshLoaded = false;
+
+    renderer.layoutMaterial = LoadMaterialDefault();
+    renderer.layoutMeshLoaded = false;
+}
+
+void UnloadRenderer(Renderer &renderer)
+{
+    UnloadTexture(renderer.moonSoilTexture);
+    UnloadMaterial(renderer.moonMaterial);
+    UnloadModel(renderer.plane);
+    for (int lod = 0; lod < sphereLodCount; lod++)
+    {
+        UnloadMesh(renderer.sphereMeshes[lod]);
+        UnloadMesh(renderer.sphereWireMeshes[lod]);
+    }
+    UnloadMesh(renderer.impostorMesh);
+    if (renderer.pathMeshLoaded)
+    {
+        UnloadMesh(renderer.pathMesh);
+    }
+    UnloadMaterial(renderer.pathMaterial);
+    UnloadMesh(renderer.cubeMesh);
+    if (renderer.layoutMeshLoaded)
+    {
+        UnloadMesh(renderer.layoutMesh);
+    }
+    UnloadMaterial(renderer.layoutMaterial);
+
+    // The instanced materials all borrow the instancing shader, so it is unloaded once.
+    MemFree(renderer.targetMaterial.maps);
+    MemFree(renderer.targetWireMaterial.maps);
+    MemFree(renderer.missileMaterial.maps);
+    UnloadShader(renderer.instancingShader);
+}
+
+static Vector4 NormalizePlane(float a, float b, float c, float d)
+{
+    float length = sqrtf(a * a + b * b + c * c);
+    return (Vector4){a / length, b / length, c / length, d / length};
+}
+
+// Gribb-Hartmann: each plane is the last row of the view-projection matrix
+// plus or minus one of the others.
+Frustum ExtractFrustum(Matrix m)
+{
+    Frustum frustum;
+    frustum.planes[0] = NormalizePlane(m.m3 + m.m0, m.m7 + m.m4, m.m11 + m.m8, m.m15 + m.m12);
+    frustum.planes[1] = NormalizePlane(m.m3 - m.m0, m.m7 - m.m4, m.m11 - m.m8, m.m15 - m.m12);
+    frustum.planes[2] = NormalizePlane(m.m3 + m.m1, m.m7 + m.m5, m.m11 + m.m9, m.m15 + m.m13);
+    frustum.planes[3] = NormalizePlane(m.m3 - m.m1, m.m7 - m.m5, m.m11 - m.m9, m.m15 - m.m13);
+    frustum.planes[4] = NormalizePlane(m.m3 + m.m2, m.m7 + m.m6, m.m11 + m.m10, m.m15 + m.m14);
+    frustum.planes[5] = NormalizePlane(m.m3 - m.m2, m.m7 - m.m6, m.m11 - m.m10, m.m15 - m.m14);
+    return frustum;
+}
+
+bool SphereInFrustum(const Frustum &frustum, Vector3 center, float radius)
+{
+    for (const Vector4 &plane : frustum.planes)
+    {
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Conservative: only rejects a box when its corner furthest along some plane
+// normal is still outside that plane.
+bool BoxInFrustum(const Frustum &frustum, BoundingBox box)
+{
+    for (const Vector4 &plane : frustum.planes)
+    {
+        float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+        float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+        float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+BoundingBox TowerBounds(const Tower &tower)
+{
+    float halfWidth = (0.5f + (tower.upgradeLevel * 0.05f)) / 2.0f;
+    float halfHeight = (2.0f + (tower.upgradeLevel * 0.1f)) / 2.0f;
+    float turretTop = 1.0f + 0.3f + (tower.upgradeLevel * 0.05f);
+    Vector3 extent = {halfWidth, fmaxf(halfHeight, turretTop), halfWidth};
+    BoundingBox box;
+    box.min = Vector3Subtract(Vector3Min(tower.startPos, tower.endPos), extent);
+    box.max = Vector3Add(Vector3Max(tower.startPos, tower.endPos), extent);
+    return box;
+}
+
+BoundingBox FenceBounds(const Fence &fence)
+{
+    const float halfWidth = 0.1f;
+    const float halfHeight = 1.0f;
+    const float lifeSphereTop = 2.0f + 0.5f + 0.7f;
+    BoundingBox box;
+    box.min = Vector3Min(fence.startPos, fence.endPos);
+    box.max = Vector3Max(fence.startPos, fence.endPos);
+    box.min = Vector3Subtract(box.min, (Vector3){halfWidth, halfHeight, halfWidth});
+    box.max = Vector3Add(box.max, (Vector3){halfWidth, lifeSphereTop, halfWidth});
+    return box;
+}
+
+// Towers and fences share one static mesh, so culling them only decides
+// whether that mesh is drawn at all; the counts still reflect each entity.
+bool CullLayout(const RenderSnapshot &snapshot, Renderer &renderer)
+{
+    renderer.towerCulling = CullStats();
+    renderer.fenceCulling = CullStats();
+    for (const auto &tower : snapshot.towers)
+    {
+        if (!tower.active)
+            continue;
+        if (BoxInFrustum(renderer.frustum, TowerBounds(tower)))
+            renderer.towerCulling.drawn++;
+        else
+            renderer.towerCulling.culled++;
+    }
+    for (const auto &fence : snapshot.fences)
+    {
+        if (!fence.fenceActive)
+            continue;
+        if (BoxInFrustum(renderer.frustum, FenceBounds(fence)))
+            renderer.fenceCulling.drawn++;
+        else
+            renderer.fenceCulling.culled++;
+    }
+    bool playerVisible = SphereInFrustum(renderer.frustum, (Vector3){0.0f, 0.1f, 0.0f}, 0.5f);
+    return playerVisible || renderer.towerCulling.drawn > 0 || renderer.fenceCulling.drawn > 0;
+}
+
+void UpdateBillboardBasis(const Camera3D &camera, Renderer &renderer)
+{
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    renderer.billboardRight = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    renderer.billboardUp = Vector3CrossProduct(renderer.billboardRight, forward);
+    renderer.billboardFacing = Vector3Negate(forward);
+}
+
+int SelectSphereLod(const Renderer &renderer, Vector3 cameraPosition, Vector3 position)
+{
+    float distanceSquared = Vector3DistanceSqr(cameraPosition, position);
+    int lod = 0;
+    while (lod < sphereLodCount && distanceSquared > renderer.lodDistances[lod] * renderer.lodDistances[lod])
+    {
+        lod++;
+    }
+    return lod;
+}
+
+void ClearLodBatch(LodBatch &batch)
+{
+    // clear() keeps each buffer's capacity, so steady-state frames do not allocate.
+    for (auto &transforms : batch.transforms)
+    {
+        transforms.clear();
+    }
+}
+
+void AddLodInstance(const Renderer &renderer, LodBatch &batch, int lod, Vector3 position, float radius)
+{
+    Matrix transform = MatrixScale(radius, radius, radius);
+    if (lod == sphereLodCount)
+    {
+        // The impostor lies in the XZ plane facing +Y; turn that towards the camera.
+        Vector3 right = Vector3Scale(renderer.billboardRight, radius);
+        Vector3 facing = Vector3Scale(renderer.billboardFacing, radius);
+        Vector3 up = Vector3Scale(renderer.billboardUp, radius);
+        transform.m0 = right.x;
+        transform.m1 = right.y;
+        transform.m2 = right.z;
+        transform.m4 = facing.x;
+        transform.m5 = facing.y;
+        transform.m6 = facing.z;
+        transform.m8 = up.x;
+        transform.m9 = up.y;
+        transform.m10 = up.z;
+    }
+    transform.m12 = position.x;
+    transform.m13 = position.y;
+    transform.m14 = position.z;
+    batch.transforms[lod].push_back(transform);
+}
+
+// One instanced draw per LOD. Wireframes are only drawn on the sphere LODs;
+// the impostor is drawn double-sided so its winding does not matter.
+void DrawLodBatch(const Renderer &renderer, const LodBatch &batch, const Material &material,
+                  const Material *wireMaterial)
+{
+    for (int lod = 0; lod < sphereLodCount; lod++)
+    {
+        const vector<Matrix> &transforms = batch.transforms[lod];
+        if (transforms.empty())
+            continue;
+        DrawMeshInstanced(renderer.sphereMeshes[lod], material, transforms.data(), (int)transforms.size());
+        if (wireMaterial != nullptr)
+        {
+            rlEnableWireMode();
+            DrawMeshInstanced(renderer.sphereWireMeshes[lod], *wireMaterial, transforms.data(),
+                              (int)transforms.size());
+            rlDisableWireMode();
+        }
+    }
+
+    const vector<Matrix> &impostors = batch.transforms[sphereLodCount];
+    if (!impostors.empty())
+    {
+        rlDisableBackfaceCulling();
+        DrawMeshInstanced(renderer.impostorMesh, material, impostors.data(), (int)impostors.size());
+        rlEnableBackfaceCulling();
+    }
+}
+
+void RenderTargets(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer)
+{
+    ClearLodBatch(renderer.targetBatch);
+    renderer.targetCulling = CullStats();
+    for (size_t i = 0; i < snapshot.targetPositions.size(); i++)
+    {
+        Vector3 position = snapshot.targetPositions[i];
+        float radius = snapshot.targetRadius[i];
+        if (!SphereInFrustum(renderer.frustum, position, radius))
+        {
+            renderer.targetCulling.culled++;
+            continue;
+        }
+        renderer.targetCulling.drawn++;
+        int lod = SelectSphereLod(renderer, camera.position, position);
+        AddLodInstance(renderer, renderer.targetBatch, lod, position, radius);
+    }
+    DrawLodBatch(renderer, renderer.targetBatch, renderer.targetMaterial, &renderer.targetWireMaterial);
+}
+
+void RenderMissiles(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer)
+{
+    const float missileRadius = 0.1f;
+
+    ClearLodBatch(renderer.missileBatch);
+    renderer.missileCulling = CullStats();
+    for (const Vector3 &position : snapshot.missilePositions)
+    {
+        if (!SphereInFrustum(renderer.frustum, position, missileRadius))
+        {
+            renderer.missileCulling.culled++;
+            continue;
+        }
+        renderer.missileCulling.drawn++;
+        int lod = SelectSphereLod(renderer, camera.position, position);
+        AddLodInstance(renderer, renderer.missileBatch, lod, position, missileRadius);
+    }
+    DrawLodBatch(renderer, renderer.missileBatch, renderer.missileMaterial, nullptr);
+}
+
+void AppendPathRibbon(vector<float> &vertices, const vector<Vector3> &waypoints, float pathWidth)
+{
+    for (size_t i = 0; i + 1 < waypoints.size(); i++)
+    {
+        Vector3 start = waypoints[i];
+        Vector3 end = waypoints[i + 1];
+        start.y = 0.05f;
+        end.y = 0.05f;
+        Vector3 direction = Vector3Normalize(Vector3Subtract(end, start));
+        Vector3 right = Vector3CrossProduct(direction, (Vector3){0.0f, 1.0f, 0.0f});
+        right = Vector3Scale(Vector3Normalize(right), pathWidth / 2.0f);
+        Vector3 p1 = Vector3Add(start, right);
+        Vector3 p2 = Vector3Subtract(start, right);
+        Vector3 p3 = Vector3Add(end, right);
+        Vector3 p4 = Vector3Subtract(end, right);
+        Vector3 corners[6] = {p1, p3, p2, p2, p3, p4};
+        for (const Vector3 &corner : corners)
+        {
+            vertices.push_back(corner.x);
+            vertices.push_back(corner.y);
+            vertices.push_back(corner.z);
+        }
+    }
+}
+
+// Rebuilds the path mesh only when the visible paths differ from the ones it was built from.
+void UpdatePathMesh(const RenderSnapshot &snapshot, Renderer &renderer)
+{
+    const float pathWidth = 2.0f;
+
+    bool current = renderer.pathMeshLoaded && renderer.pathWaypoints.size() == snapshot.paths.size();
+    for (size_t p = 0; current && p < snapshot.paths.size(); p++)
+    {
+        const vector<Vector3> &a = snapshot.paths[p];
+        const vector<Vector3> &b = renderer.pathWaypoints[p];
+        current = a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(Vector3)) == 0;
+    }
+    if (current)
+        return;
+
+    if (renderer.pathMeshLoaded)
+    {
+        UnloadMesh(renderer.pathMesh);
+        renderer.pathMeshLoaded = false;
+    }
+    renderer.pathWaypoints = snapshot.paths;
+
+    vector<float> vertices;
+    for (const auto &waypoints : renderer.pathWaypoints)
+    {
+        AppendPathRibbon(vertices, waypoints, pathWidth);
+    }
+    if (vertices.empty())
+        return;
+
+    Mesh mesh = {};
+    mesh.vertexCount = (int)vertices.size() / 3;
+    mesh.triangleCount = mesh.vertexCount / 3;
+    mesh.vertices = (float *)MemAlloc(vertices.size() * sizeof(float));
+    memcpy(mesh.vertices, vertices.data(), vertices.size() * sizeof(float));
+    mesh.normals = (float *)MemAlloc(vertices.size() * sizeof(float));
+    for (int v = 0; v < mesh.vertexCount; v++)
+    {
+        mesh.normals[v * 3 + 0] = 0.0f;
+        mesh.normals[v * 3 + 1] = 1.0f;
+        mesh.normals[v * 3 + 2] = 0.0f;
+    }
+    UploadMesh(&mesh, false);
+    renderer.pathMesh = mesh;
+    renderer.pathMeshLoaded = true;
+}
+
+// Appends src scaled about its origin and moved to center, flattening indexed meshes.
+void AppendLayoutMesh(Renderer &renderer, const Mesh &src, Vector3 center, Vector3 scale, Color color)
+{
+    int count = src.indices ? src.triangleCount * 3 : src.vertexCount;
+    for (int n = 0; n < count; n++)
+    {
+        int v = src.indices ? src.indices[n] : n;
+        renderer.layoutVertices.push_back(center.x + src.vertices[v * 3 + 0] * scale.x);
+        renderer.layoutVertices.push_back(center.y + src.vertices[v * 3 + 1] * scale.y);
+        renderer.layoutVertices.push_back(center.z + src.vertices[v * 3 + 2] * scale.z);
+        renderer.layoutColors.push_back(color.r);
+        renderer.layoutColors.push_back(color.g);
+        renderer.layoutColors.push_back(color.b);
+        renderer.layoutColors.push_back(color.a);
+    }
+}
+
+// Rebuilds the combined tower/fence/player mesh only after the layout version changes.
+void UpdateLayoutMesh(const RenderSnapshot &snapshot, Renderer &renderer)
+{
+    if (renderer.layoutMeshLoaded && renderer.layoutVersion == snapshot.layoutVersion)
+        return;
+
+    if (renderer.layoutMeshLoaded)
+    {
+        UnloadMesh(renderer.layoutMesh);
+        renderer.layoutMeshLoaded = false;
+    }
+    renderer.layoutVersion = snapshot.layoutVersion;
+    renderer.layoutVertices.clear();
+    renderer.layoutColors.clear();
+
+    for (const auto &tower : snapshot.towers)
+    {
+        if (tower.active)
+        {
+            float towerWidth = 0.5f + (tower.upgradeLevel * 0.05f);
+            float towerHeight = 2.0f + (tower.upgradeLevel * 0.1f);
+            float towerLength = 0.5f + (tower.upgradeLevel * 0.05f);
+            Vector3 towerSize = {towerWidth, towerHeight, towerLength};
+            AppendLayoutMesh(renderer, renderer.cubeMesh, tower.startPos, towerSize, GRAY);
+            AppendLayoutMesh(renderer, renderer.cubeMesh, tower.endPos, towerSize, GRAY);
+            Vector3 turretStart = tower.startPos;
+            Vector3 turretEnd = tower.endPos;
+            turretStart.y += 1.0f;
+            turretEnd.y += 1.0f;
+            float turretSize = 0.3f + (tower.upgradeLevel * 0.05f);
+            Vector3 turretScale = {turretSize, turretSize, turretSize};
+            AppendLayoutMesh(renderer, renderer.sphereMeshes[0], turretStart, turretScale, ORANGE);
+            AppendLayoutMesh(renderer, renderer.sphereMeshes[0], turretEnd, turretScale, ORANGE);
+        }
+    }
+
+    for (const auto &fence : snapshot.fences)
+    {
+        if (fence.fenceActive)
+        {
+            Vector3 center =
+                Vector3Add(fence.startPos, Vector3Scale(Vector3Subtract(fence.endPos, fence.startPos), 0.5f));
+            float length = Vector3Distance(fence.startPos, fence.endPos);
+            Vector3 direction = Vector3Normalize(Vector3Subtract(fence.endPos, fence.startPos));
+            float width = 0.2f;
+            float height = 2.0f;
+            float fenceLength = (fabs(direction.x) > fabs(direction.z)) ? length : width;
+            float fenceWidth = (fabs(direction.x) > fabs(direction.z)) ? width : length;
+            AppendLayoutMesh(renderer, renderer.cubeMesh, center, (Vector3){fenceLength, height, fenceWidth}, GRAY);
+        }
+    }
+
+    AppendLayoutMesh(renderer, renderer.cubeMesh, (Vector3){0.0f, 0.1f, 0.0f}, (Vector3){0.5f, 0.5f, 0.5f}, GREEN);
+
+    Mesh mesh = {};
+    mesh.vertexCount = (int)renderer.layoutVertices.size() / 3;
+    mesh.triangleCount = mesh.vertexCount / 3;
+    mesh.vertices = (float *)MemAlloc(renderer.layoutVertices.size() * sizeof(float));
+    memcpy(mesh.vertices, renderer.layoutVertices.data(), renderer.layoutVertices.size() * sizeof(float));
+    mesh.colors = (unsigned char *)MemAlloc(renderer.layoutColors.size());
+    memcpy(mesh.colors, renderer.layoutColors.data(), renderer.layoutColors.size());
+    UploadMesh(&mesh, false);
+    renderer.layoutMesh = mesh;
+    renderer.layoutMeshLoaded = true;
+}
+
+void RenderGame(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer)
+{
+    const float crosshairSize = 10.0f;
+    const float contactTimeLimit = 2.0f;
+    const double messageDuration = 3.0;
+    const int screenWidth = GetScreenWidth();
+    const int screenHeight = GetScreenHeight();
+
+    BeginDrawing();
+    ClearBackground(Color{0, 0, 0, 0});
+
+    BeginMode3D(camera);
+    // BeginMode3D leaves the camera's view in the modelview matrix.
+    renderer.frustum = ExtractFrustum(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+
+    rlPushMatrix();
+    rlScalef(50.0f, 1.0f, 50.0f);
+    DrawModel(renderer.plane, (Vector3){0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
+    rlPopMatrix();
+
+    UpdatePathMesh(snapshot, renderer);
+    if (renderer.pathMeshLoaded)
+    {
+        DrawMesh(renderer.pathMesh, renderer.pathMaterial, MatrixIdentity());
+    }
+
+    UpdateBillboardBasis(camera, renderer);
+    RenderTargets(snapshot, camera, renderer);
+
+    RenderMissiles(snapshot, camera, renderer);
+
+    UpdateLayoutMesh(snapshot, renderer);
+    if (renderer.layoutMeshLoaded && CullLayout(snapshot, renderer))
+    {
+        DrawMesh(renderer.layoutMesh, renderer.layoutMaterial, MatrixIdentity());
+    }
+
+    for (const auto &fence : snapshot.fences)
+    {
+        if (fence.fenceActive && fence.fenceContactTimer > 0.0f && BoxInFrustum(renderer.frustum, FenceBounds(fence)))
+        {
+            Vector3 lifeSpherePos = {(fence.startPos.x + fence.endPos.x) / 2.0f, fence.startPos.y + 2.0f + 0.5f,
+                                     (fence.startPos.z + fence.endPos.z) / 2.0f};
+            float fenceLifePercentage = 0.1f - (fence.fenceContactTimer / fence.fenceContactTimeLimit) / 2;
+
+            DrawSphere(lifeSpherePos, 0.3f - fenceLifePercentage, GREEN);
+            DrawSphereWires(lifeSpherePos, 0.7f, 10, 10, BLACK);
+        }
+    }
+
+    EndMode3D();
+
+    Vector2 lifeBarPos = GetWorldToScreen((Vector3){0.0f, 1.0f, 0.0f}, camera);
+    float lifeBarWidth = 50.0f;
+    float lifeBarHeight = 10.0f;
+    float lifePercentage = 1.0f - (snapshot.contactTimer / contactTimeLimit);
+    DrawRectangle(lifeBarPos.x - lifeBarWidth / 2, lifeBarPos.y - lifeBarHeight / 2, lifeBarWidth * lifePercentage,
+                  lifeBarHeight, GREEN);
+    DrawRectangleLines(lifeBarPos.x - lifeBarWidth / 2, lifeBarPos.y - lifeBarHeight / 2, lifeBarWidth, lifeBarHeight,
+                       BLACK);
+
+    DrawRectangle((float)screenWidth / 2 - crosshairSize / 2, screenHeight / 2 - 2, crosshairSize, 4, BLACK);
+    DrawRectangle(screenWidth / 2 - 2, (float)screenHeight / 2 - crosshairSize / 2, 4, crosshairSize, BLACK);
+    // // if you want the crosshair outlined:
+    // DrawRectangleLines((float)screenWidth / 2 - crosshairSize / 2, screenHeight / 2 - 2, crosshairSize, 4, SKYBLUE);
+    // DrawRectangleLines(screenWidth / 2 - 2, (float)screenHeight / 2 - crosshairSize / 2, 4, crosshairSize, SKYBLUE);
+
+    DrawText(TextFormat("Coins: %d", snapshot.coins), 10, 10, 20, WHITE);
+    DrawText("Press SPACE to shoot | P to Pause | T to Build Tower (50 coins)", 10, 40, 20, WHITE);
+    DrawText("If you have four towers; T to Upgrade tower (50 coins) | F to Build Fence (20 coins)", 10, 70, 20, WHITE);
+    DrawText(TextFormat("Enemies Left: %d", snapshot.enemiesLeft), 10, 130, 20, WHITE);
+    DrawText(TextFormat("Wave: %d", snapshot.waveNumber), 10, 190, 20, WHITE);
+
+    const char *moveText = "(You can move with W (forward) | A (left) | S (down) | D (right))";
+    int textWidth = MeasureText(moveText, 20);
+    int x = (GetScreenWidth() - textWidth) / 2;
+    int y = 600;
+    DrawText(moveText, x, y, 20, WHITE);
+
+    if (!snapshot.waveActive)
+    {
+        DrawText(TextFormat("Next Wave In: %.1f", snapshot.waveDelay - snapshot.waveDelayTimer), 10, 220, 20, WHITE);
+    }
+
+    if (snapshot.messageCount != renderer.messageCount)
+    {
+        renderer.messageCount = snapshot.messageCount;
+        renderer.messageTime = GetTime();
+    }
+    if (snapshot.message && GetTime() - renderer.messageTime < messageDuration)
+    {
+        DrawText(snapshot.message, 10, 250, 20, YELLOW);
+    }
+
+    if (snapshot.pause)
+    {
+        DrawText("Paused", screenWidth / 2 - MeasureText("Paused", 40) / 2, screenHeight / 2 - 20, 40, BLUE);
+        DrawText("Press P to Resume", screenWidth / 2 - MeasureText("Press P to Resume", 20) / 2, screenHeight / 2 + 20,
+                 20, BLACK);
+    }
+
+    if (snapshot.gameOver)
+    {
+        DrawText("Game Over!", screenWidth / 2 - MeasureText("Game Over!", 40) / 2, screenHeight / 2 - 20, 40, RED);
+        DrawText("Press R to Restart", screenWidth / 2 - MeasureText("Press R to Restart", 20) / 2,
+                 screenHeight / 2 + 20, 20, BLACK);
+    }
+
+    DrawFPS(screenWidth - 90, 10);
+}
+
+void DrawProfilerOverlay(Profiler &profiler, const RenderSnapshot &snapshot, const Renderer &renderer)
+{
+    const int fontSize = 10;
+    const int lineHeight = 14;
+    const int width = 360;
+    const int x = GetScreenWidth() - width - 10;
+    int y = 40;
+
+    DrawRectangle(x - 5, y - 5, width + 10, (PROFILE_STAGE_COUNT + 6) * lineHeight + 10, Fade(BLACK, 0.7f));
+    DrawText(TextFormat("%-16s %8s %8s %8s  (ms, last %d)", "stage", "mean", "max", "p99", profileHistory), x, y,
+             fontSize, YELLOW);
+    y += lineHeight;
+    for (int stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        ProfileStats stats = GetProfileStats(profiler, (ProfileStage)stage);
+        DrawText(TextFormat("%-16s %8.3f %8.3f %8.3f", ProfileStageName((ProfileStage)stage), stats.mean, stats.max,
+                            stats.p99),
+                 x, y, fontSize, WHITE);
+        y += lineHeight;
+    }
+
+    y += lineHeight;
+    DrawText(TextFormat("tick %u  targets %d  missiles %d  towers %d  fences %d", snapshot.tick,
+                        (int)snapshot.targetPositions.size(), (int)snapshot.missilePositions.size(),
+                        (int)snapshot.towers.size(), (int)snapshot.fences.size()),
+             x, y, fontSize, WHITE);
+    y += lineHeight;
+    DrawText(TextFormat("drawn/culled  targets %d/%d  missiles %d/%d", renderer.targetCulling.drawn,
+                        renderer.targetCulling.culled, renderer.missileCulling.drawn, renderer.missileCulling.culled),
+             x, y, fontSize, WHITE);
+    y += lineHeight;
+    DrawText(TextFormat("drawn/culled  towers %d/%d  fences %d/%d", renderer.towerCulling.drawn,
+                        renderer.towerCulling.culled, renderer.fenceCulling.drawn, renderer.fenceCulling.culled),
+             x, y, fontSize, WHITE);
+    y += lineHeight;
+    const LodBatch &targets = renderer.targetBatch;
+    DrawText(TextFormat("target LODs  %d / %d / %d / impostor %d", (int)targets.transforms[0].size(),
+                        (int)targets.transforms[1].size(), (int)targets.transforms[2].size(),
+                        (int)targets.transforms[sphereLodCount].size()),
+             x, y, fontSize, WHITE);
+}
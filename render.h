@@ -0,0 +1,95 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "snapshot.h"
+
+// Sphere tessellations from near to far; anything beyond the last threshold is
+// drawn as a camera-facing impostor disc at index sphereLodCount.
+const int sphereLodCount = 3;
+
+// Per-LOD instance transforms for one kind of sphere, rebuilt every frame. The
+// vector sizes after a frame are the per-LOD instance counts.
+struct LodBatch
+{
+    vector<Matrix> transforms[sphereLodCount + 1];
+};
+
+// View volume as six planes (a, b, c, d) with normals pointing inwards, so a
+// point p is inside when a * p.x + b * p.y + c * p.z + d >= 0 for every plane.
+struct Frustum
+{
+    Vector4 planes[6];
+};
+
+// Entities that passed or failed the frustum test in the last frame.
+struct CullStats
+{
+    int drawn = 0;
+    int culled = 0;
+};
+
+struct Renderer
+{
+    Texture2D moonSoilTexture;
+    Material moonMaterial;
+    Model plane;
+    Shader instancingShader;
+    Mesh sphereMeshes[sphereLodCount];
+    Mesh sphereWireMeshes[sphereLodCount];
+    Mesh impostorMesh;
+    // Camera distances at which each sphere LOD hands over to the next one.
+    float lodDistances[sphereLodCount] = {20.0f, 40.0f, 80.0f};
+    Vector3 billboardRight;
+    Vector3 billboardUp;
+    Vector3 billboardFacing;
+    Mesh cubeMesh;
+    Material targetMaterial;
+    Material targetWireMaterial;
+    Material missileMaterial;
+    LodBatch targetBatch;
+    LodBatch missileBatch;
+    Frustum frustum;
+    CullStats targetCulling;
+    CullStats missileCulling;
+    CullStats towerCulling;
+    CullStats fenceCulling;
+    Mesh pathMesh;
+    Material pathMaterial;
+    bool pathMeshLoaded = false;
+    vector<vector<Vector3>> pathWaypoints;
+    Mesh layoutMesh;
+    Material layoutMaterial;
+    bool layoutMeshLoaded = false;
+    unsigned int layoutVersion = 0;
+    vector<float> layoutVertices;
+    vector<unsigned char> layoutColors;
+    // When the HUD started showing the snapshot's current message.
+    unsigned int messageCount = 0;
+    double messageTime = 0.0;
+};
+
+void LoadRenderer(Renderer &renderer);
+void UnloadRenderer(Renderer &renderer);
+Frustum ExtractFrustum(Matrix viewProjection);
+bool SphereInFrustum(const Frustum &frustum, Vector3 center, float radius);
+bool BoxInFrustum(const Frustum &frustum, BoundingBox box);
+BoundingBox TowerBounds(const Tower &tower);
+BoundingBox FenceBounds(const Fence &fence);
+bool CullLayout(const RenderSnapshot &snapshot, Renderer &renderer);
+void UpdateBillboardBasis(const Camera3D &camera, Renderer &renderer);
+int SelectSphereLod(const Renderer &renderer, Vector3 cameraPosition, Vector3 position);
+void ClearLodBatch(LodBatch &batch);
+void AddLodInstance(const Renderer &renderer, LodBatch &batch, int lod, Vector3 position, float radius);
+void DrawLodBatch(const Renderer &renderer, const LodBatch &batch, const Material &material,
+                  const Material *wireMaterial);
+void RenderTargets(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer);
+void RenderMissiles(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer);
+void AppendPathRibbon(vector<float> &vertices, const vector<Vector3> &waypoints, float pathWidth);
+void UpdatePathMesh(const RenderSnapshot &snapshot, Renderer &renderer);
+void AppendLayoutMesh(Renderer &renderer, const Mesh &src, Vector3 center, Vector3 scale, Color color);
+void UpdateLayoutMesh(const RenderSnapshot &snapshot, Renderer &renderer);
+// Draws the frame but leaves it open; the caller ends it with EndDrawing so that can be timed on its own.
+void RenderGame(const RenderSnapshot &snapshot, const Camera3D &camera, Renderer &renderer);
+void DrawProfilerOverlay(Profiler &profiler, const RenderSnapshot &snapshot, const Renderer &renderer);
+
+#endif
@@ -0,0 +1,221 @@
+#include "replay.h"
+#include "game.h"
+
+#include <cstring>
+
+// File layout, all integers and floats little-endian:
+//   "KSRP", u32 version, f32 tickRate, i32 coins, i32 baseEnemies, i32 maxMissiles, u64 levelHash
+//   then per command: u32 tick, u8 type, and for shots f32 position[3], f32 direction[3]
+// A type of replayEndMarker closes the file. Version 1 recordings have no
+// levelHash and were all made on the first level.
+static const char replayMagic[4] = {'K', 'S', 'R', 'P'};
+const unsigned int replayVersion = 2;
+const unsigned char replayEndMarker = 0xFF;
+
+static void WriteU32(FILE *file, unsigned int value)
+{
+    unsigned char bytes[4] = {(unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16),
+                              (unsigned char)(value >> 24)};
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void WriteF32(FILE *file, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(file, bits);
+}
+
+static void WriteVector3(FILE *file, Vector3 value)
+{
+    WriteF32(file, value.x);
+    WriteF32(file, value.y);
+    WriteF32(file, value.z);
+}
+
+// Reads from a byte buffer and remembers whether it ran past the end.
+struct ReplayReader
+{
+    const vector<unsigned char> &bytes;
+    size_t offset;
+    bool failed;
+};
+
+static unsigned int ReadU32(ReplayReader &reader)
+{
+    if (reader.offset + 4 > reader.bytes.size())
+    {
+        reader.failed = true;
+        return 0;
+    }
+    const unsigned char *b = &reader.bytes[reader.offset];
+    reader.offset += 4;
+    return (unsigned int)b[0] | (unsigned int)b[1] << 8 | (unsigned int)b[2] << 16 | (unsigned int)b[3] << 24;
+}
+
+static unsigned char ReadU8(ReplayReader &reader)
+{
+    if (reader.offset + 1 > reader.bytes.size())
+    {
+        reader.failed = true;
+        return 0;
+    }
+    return reader.bytes[reader.offset++];
+}
+
+static float ReadF32(ReplayReader &reader)
+{
+    unsigned int bits = ReadU32(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static Vector3 ReadVector3(ReplayReader &reader)
+{
+    Vector3 value;
+    value.x = ReadF32(reader);
+    value.y = ReadF32(reader);
+    value.z = ReadF32(reader);
+    return value;
+}
+
+bool StartRecording(Recorder &recorder, const Game &game, const char *path)
+{
+    recorder.file = fopen(path, "wb");
+    if (!recorder.file)
+        return false;
+    fwrite(replayMagic, 1, sizeof(replayMagic), recorder.file);
+    WriteU32(recorder.file, replayVersion);
+    WriteF32(recorder.file, game.tickRate);
+    WriteU32(recorder.file, (unsigned int)game.coins);
+    WriteU32(recorder.file, (unsigned int)game.waves.baseEnemies);
+    WriteU32(recorder.file, (unsigned int)game.maxMissiles);
+    WriteU32(recorder.file, (unsigned int)game.levelHash);
+    WriteU32(recorder.file, (unsigned int)(game.levelHash >> 32));
+    return true;
+}
+
+void RecordCommand(Recorder &recorder, unsigned int tick, const Command &command)
+{
+    if (!recorder.file)
+        return;
+    WriteU32(recorder.file, tick);
+    fputc((unsigned char)command.type, recorder.file);
+    if (command.type == COMMAND_FIRE)
+    {
+        WriteVector3(recorder.file, command.position);
+        WriteVector3(recorder.file, command.direction);
+    }
+}
+
+void StopRecording(Recorder &recorder, unsigned int tick)
+{
+    if (!recorder.file)
+        return;
+    WriteU32(recorder.file, tick);
+    fputc(replayEndMarker, recorder.file);
+    fclose(recorder.file);
+    recorder.file = nullptr;
+}
+
+bool LoadReplay(Replay &replay, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    vector<unsigned char> bytes;
+    unsigned char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+
+    if (bytes.size() < sizeof(replayMagic) || memcmp(bytes.data(), replayMagic, sizeof(replayMagic)) != 0)
+        return false;
+    ReplayReader reader = {bytes, sizeof(replayMagic), false};
+    unsigned int version = ReadU32(reader);
+    if (version != 1 && version != replayVersion)
+        return false;
+    replay.tickRate = ReadF32(reader);
+    replay.coins = (int)ReadU32(reader);
+    replay.baseEnemies = (int)ReadU32(reader);
+    replay.maxMissiles = (int)ReadU32(reader);
+    replay.levelHash = 0;
+    if (version >= 2)
+    {
+        replay.levelHash = ReadU32(reader);
+        replay.levelHash |= (uint64_t)ReadU32(reader) << 32;
+    }
+
+    replay.commands.clear();
+    replay.next = 0;
+    replay.finished = false;
+    while (!reader.failed && reader.offset < bytes.size())
+    {
+        RecordedCommand recorded = {};
+        recorded.tick = ReadU32(reader);
+        unsigned char type = ReadU8(reader);
+        recorded.end = type == replayEndMarker;
+        recorded.type = type;
+        if (type == COMMAND_FIRE)
+        {
+            recorded.position = ReadVector3(reader);
+            recorded.direction = ReadVector3(reader);
+        }
+        else if (!recorded.end && type > COMMAND_RESET)
+        {
+            reader.failed = true;
+        }
+        if (reader.failed)
+            break;
+        replay.commands.push_back(recorded);
+        if (recorded.end)
+            break;
+    }
+    // A recording cut short by a crash is still replayable up to its last whole command.
+    return !replay.commands.empty() || !reader.failed;
+}
+
+// Call straight after InitializeGame with the replay's level, before anything is bought.
+void ApplyReplayConfig(const Replay &replay, Game &game)
+{
+    game.tickRate = replay.tickRate;
+    game.coins = replay.coins;
+    game.waves.baseEnemies = replay.baseEnemies;
+    game.maxEnemies = replay.baseEnemies;
+    game.maxMissiles = replay.maxMissiles;
+    game.missiles.slots.resize(game.maxMissiles);
+}
+
+// Returns the level the replay was recorded on, or -1 if the level config no
+// longer has it, in which case the replay would not play out as recorded.
+int ReplayLevel(const Replay &replay, const LevelSet &levels)
+{
+    return replay.levelHash == 0 ? 0 : FindLevelByHash(levels, replay.levelHash);
+}
+
+void ApplyReplayCommands(Replay &replay, Game &game)
+{
+    while (!replay.finished && replay.next < replay.commands.size() &&
+           replay.commands[replay.next].tick == game.tick)
+    {
+        const RecordedCommand &recorded = replay.commands[replay.next++];
+        if (recorded.end)
+        {
+            replay.finished = true;
+            break;
+        }
+        Command command;
+        command.type = (CommandType)recorded.type;
+        command.position = recorded.position;
+        command.direction = recorded.direction;
+        ApplyCommand(game, command);
+    }
+    if (replay.next >= replay.commands.size())
+    {
+        replay.finished = true;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+struct Game;
+struct LevelSet;
+struct Command;
+
+// A command together with the tick it was applied on. The end marker records
+// the tick the recording stopped at.
+struct RecordedCommand
+{
+    unsigned int tick;
+    int type;
+    Vector3 position;
+    Vector3 direction;
+    bool end;
+};
+
+// Appends every command ApplyCommand sees to a file, after a header holding
+// the game settings the run started from.
+struct Recorder
+{
+    FILE *file = nullptr;
+};
+
+// A loaded recording. UpdateGame applies the commands due on each tick in
+// recorded order, so the run plays out exactly as it was recorded.
+struct Replay
+{
+    float tickRate = 60.0f;
+    int coins = 0;
+    int baseEnemies = 0;
+    int maxMissiles = 0;
+    // Hash of the level it was recorded on, 0 for the first level.
+    uint64_t levelHash = 0;
+    vector<RecordedCommand> commands;
+    size_t next = 0;
+    bool finished = false;
+};
+
+bool StartRecording(Recorder &recorder, const Game &game, const char *path);
+void RecordCommand(Recorder &recorder, unsigned int tick, const Command &command);
+void StopRecording(Recorder &recorder, unsigned int tick);
+bool LoadReplay(Replay &replay, const char *path);
+void ApplyReplayConfig(const Replay &replay, Game &game);
+int ReplayLevel(const Replay &replay, const LevelSet &levels);
+void ApplyReplayCommands(Replay &replay, Game &game);
+
+#endif
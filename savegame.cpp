@@ -0,0 +1,390 @@
+#include "savegame.h"
+#include "game.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A save is a header followed by the game's scalars and then every entity
+// array as one block: a u64 element count and the elements' bytes. Blocks are
+// the in-memory layout, so saving and loading are a memcpy per array. That
+// layout is little-endian on every platform the game ships on; the header
+// records the struct sizes so a build with a different layout refuses the file
+// instead of misreading it.
+static const char saveMagic[4] = {'K', 'S', 'S', 'V'};
+const uint32_t saveVersion = 6;
+
+struct SaveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t targetSize;
+    uint32_t missileSize;
+    uint32_t towerSize;
+    uint32_t fenceSize;
+    uint32_t wavesSize;
+};
+
+static SaveHeader CurrentSaveHeader()
+{
+    SaveHeader header;
+    memcpy(header.magic, saveMagic, sizeof(saveMagic));
+    header.version = saveVersion;
+    header.targetSize = sizeof(Target);
+    header.missileSize = sizeof(Missile);
+    header.towerSize = sizeof(Tower);
+    header.fenceSize = sizeof(Fence);
+    header.wavesSize = sizeof(WaveSchedule);
+    return header;
+}
+
+static bool IsLittleEndian()
+{
+    uint32_t value = 1;
+    unsigned char first;
+    memcpy(&first, &value, 1);
+    return first == 1;
+}
+
+template <typename T>
+static void Put(vector<unsigned char> &out, const T &value)
+{
+    const unsigned char *bytes = (const unsigned char *)&value;
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static void PutArray(vector<unsigned char> &out, const T *values, size_t count)
+{
+    Put(out, (uint64_t)count);
+    const unsigned char *bytes = (const unsigned char *)values;
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+template <typename T>
+static void PutArray(vector<unsigned char> &out, const vector<T> &values)
+{
+    PutArray(out, values.data(), values.size());
+}
+
+static void PutSlotTable(vector<unsigned char> &out, const SlotTable &table)
+{
+    PutArray(out, table.denseOf);
+    PutArray(out, table.generation);
+    PutArray(out, table.slotOf);
+    PutArray(out, table.freeSlots);
+}
+
+// Bounds-checked cursor over a mapped save file; any overrun marks it failed.
+struct SaveReader
+{
+    const unsigned char *data;
+    size_t size;
+    size_t offset;
+    bool failed;
+};
+
+template <typename T>
+static void Get(SaveReader &reader, T &value)
+{
+    if (reader.failed || reader.size - reader.offset < sizeof(T))
+    {
+        reader.failed = true;
+        return;
+    }
+    memcpy(&value, reader.data + reader.offset, sizeof(T));
+    reader.offset += sizeof(T);
+}
+
+template <typename T>
+static void GetArray(SaveReader &reader, vector<T> &values)
+{
+    uint64_t count = 0;
+    Get(reader, count);
+    if (reader.failed || count > (reader.size - reader.offset) / sizeof(T))
+    {
+        reader.failed = true;
+        return;
+    }
+    values.resize((size_t)count);
+    memcpy(values.data(), reader.data + reader.offset, (size_t)count * sizeof(T));
+    reader.offset += (size_t)count * sizeof(T);
+}
+
+// A table read from disk is only trusted if every slot is either live,
+// mapped one to one with a dense index below denseSize, or free, so no
+// handle operation can index outside it.
+static bool ValidSlotTable(const SlotTable &table, size_t denseSize)
+{
+    size_t slots = table.generation.size();
+    if (table.denseOf.size() != slots || table.slotOf.size() != denseSize ||
+        denseSize + table.freeSlots.size() != slots)
+        return false;
+    vector<unsigned char> seen(slots, 0);
+    for (size_t i = 0; i < denseSize; i++)
+    {
+        unsigned int slot = table.slotOf[i];
+        if (slot >= slots || seen[slot] || table.denseOf[slot] != i)
+            return false;
+        seen[slot] = 1;
+    }
+    for (unsigned int slot : table.freeSlots)
+    {
+        if (slot >= slots || seen[slot])
+            return false;
+        seen[slot] = 1;
+    }
+    for (unsigned int generation : table.generation)
+    {
+        if (generation == 0)
+            return false;
+    }
+    return true;
+}
+
+static void GetSlotTable(SaveReader &reader, SlotTable &table)
+{
+    GetArray(reader, table.denseOf);
+    GetArray(reader, table.generation);
+    GetArray(reader, table.slotOf);
+    GetArray(reader, table.freeSlots);
+}
+
+bool SaveGame(const Game &game, const char *path)
+{
+    if (!IsLittleEndian())
+        return false;
+
+    vector<unsigned char> out;
+    Put(out, CurrentSaveHeader());
+
+    Put(out, game.waves);
+    Put(out, game.levelHash);
+    Put(out, game.navigation);
+    Put(out, game.waveNumber);
+    Put(out, game.maxEnemies);
+    Put(out, game.maxMissiles);
+    Put(out, game.spawnTimer);
+    Put(out, game.spawnDelay);
+    Put(out, game.enemiesSpawned);
+    Put(out, game.waveDelayTimer);
+    Put(out, game.waveActive);
+    Put(out, game.secondPathActive);
+    Put(out, game.coins);
+    Put(out, game.contactTimer);
+    Put(out, game.inContact);
+    Put(out, game.gameOver);
+    Put(out, game.pause);
+    Put(out, game.towerCount);
+    Put(out, game.fenceCount);
+    Put(out, game.canUpgrade);
+    Put(out, game.target);
+    Put(out, game.tickRate);
+    Put(out, game.tickAccumulator);
+    Put(out, game.tick);
+
+    Put(out, (uint64_t)game.allWaypoints.size());
+    for (const auto &waypoints : game.allWaypoints)
+    {
+        PutArray(out, waypoints);
+    }
+
+    const TargetPool &targets = game.targets;
+    PutArray(out, targets.x);
+    PutArray(out, targets.y);
+    PutArray(out, targets.z);
+    PutArray(out, targets.radius);
+    PutArray(out, targets.speed);
+    PutArray(out, targets.lifeTimer);
+    PutArray(out, targets.lifeTimeLimit);
+    PutArray(out, targets.pathDistance);
+    PutArray(out, targets.pathSegment);
+    PutArray(out, targets.pathIndex);
+    PutArray(out, targets.active);
+    PutArray(out, targets.stopped);
+    PutSlotTable(out, targets.handles);
+
+    PutArray(out, game.missiles.slots.data(), game.missiles.count);
+    PutSlotTable(out, game.missiles.handles);
+    PutArray(out, game.towers.items);
+    PutSlotTable(out, game.towers.handles);
+    PutArray(out, game.fences.items);
+    PutSlotTable(out, game.fences.handles);
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return fclose(file) == 0 && written;
+}
+
+// Parses a whole save into state, leaving it unusable if the file is not a
+// complete save from a build with the same layout.
+static bool ReadSave(const unsigned char *data, size_t size, Game &state)
+{
+    SaveReader reader = {data, size, 0, false};
+    SaveHeader header;
+    SaveHeader expected = CurrentSaveHeader();
+    Get(reader, header);
+    if (reader.failed || memcmp(&header, &expected, sizeof(header)) != 0)
+        return false;
+
+    Get(reader, state.waves);
+    Get(reader, state.levelHash);
+    Get(reader, state.navigation);
+    Get(reader, state.waveNumber);
+    Get(reader, state.maxEnemies);
+    Get(reader, state.maxMissiles);
+    Get(reader, state.spawnTimer);
+    Get(reader, state.spawnDelay);
+    Get(reader, state.enemiesSpawned);
+    Get(reader, state.waveDelayTimer);
+    Get(reader, state.waveActive);
+    Get(reader, state.secondPathActive);
+    Get(reader, state.coins);
+    Get(reader, state.contactTimer);
+    Get(reader, state.inContact);
+    Get(reader, state.gameOver);
+    Get(reader, state.pause);
+    Get(reader, state.towerCount);
+    Get(reader, state.fenceCount);
+    Get(reader, state.canUpgrade);
+    Get(reader, state.target);
+    Get(reader, state.tickRate);
+    Get(reader, state.tickAccumulator);
+    Get(reader, state.tick);
+
+    uint64_t pathCount = 0;
+    Get(reader, pathCount);
+    if (reader.failed || pathCount > size)
+        return false;
+    state.allWaypoints.resize((size_t)pathCount);
+    for (auto &waypoints : state.allWaypoints)
+    {
+        GetArray(reader, waypoints);
+    }
+
+    TargetPool &targets = state.targets;
+    GetArray(reader, targets.x);
+    GetArray(reader, targets.y);
+    GetArray(reader, targets.z);
+    GetArray(reader, targets.radius);
+    GetArray(reader, targets.speed);
+    GetArray(reader, targets.lifeTimer);
+    GetArray(reader, targets.lifeTimeLimit);
+    GetArray(reader, targets.pathDistance);
+    GetArray(reader, targets.pathSegment);
+    GetArray(reader, targets.pathIndex);
+    GetArray(reader, targets.active);
+    GetArray(reader, targets.stopped);
+    GetSlotTable(reader, targets.handles);
+
+    GetArray(reader, state.missiles.slots);
+    GetSlotTable(reader, state.missiles.handles);
+    GetArray(reader, state.towers.items);
+    GetSlotTable(reader, state.towers.handles);
+    GetArray(reader, state.fences.items);
+    GetSlotTable(reader, state.fences.handles);
+    if (reader.failed || reader.offset != size)
+        return false;
+
+    // Every per-target array must match, and the pool and its live missiles must fit the capacity.
+    size_t count = targets.x.size();
+    if (targets.y.size() != count || targets.z.size() != count || targets.radius.size() != count ||
+        targets.speed.size() != count || targets.lifeTimer.size() != count ||
+        targets.lifeTimeLimit.size() != count || targets.pathDistance.size() != count ||
+        targets.pathSegment.size() != count || targets.pathIndex.size() != count || targets.active.size() != count ||
+        targets.stopped.size() != count || state.maxMissiles < 0 || state.maxMissiles > missileCapacity ||
+        state.missiles.slots.size() > (size_t)state.maxMissiles)
+        return false;
+    if (!ValidSlotTable(targets.handles, count) ||
+        !ValidSlotTable(state.missiles.handles, state.missiles.slots.size()) ||
+        !ValidSlotTable(state.towers.handles, state.towers.items.size()) ||
+        !ValidSlotTable(state.fences.handles, state.fences.items.size()))
+        return false;
+
+    // Every target must sit on a segment of a path with at least two waypoints,
+    // and spawning needs the first path, and the second once it has opened.
+    if ((uint32_t)state.navigation > NAVIGATION_FLOW_FIELD || state.allWaypoints.empty() ||
+        (state.secondPathActive && state.allWaypoints.size() < 2))
+        return false;
+    for (const auto &waypoints : state.allWaypoints)
+    {
+        if (waypoints.size() < 2)
+            return false;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        int path = targets.pathIndex[i];
+        if (path < 0 || path >= (int)state.allWaypoints.size() || targets.pathSegment[i] < 0 ||
+            targets.pathSegment[i] + 1 >= (int)state.allWaypoints[path].size())
+            return false;
+    }
+    BuildPaths(state);
+
+    state.missiles.count = state.missiles.slots.size();
+    state.missiles.slots.resize(state.maxMissiles);
+    return true;
+}
+
+// Replaces the game's state with the save at path and leaves the game
+// untouched if the file cannot be read. The attached job system, profiler,
+// recorder and replay are kept.
+bool LoadGame(Game &game, const char *path)
+{
+    if (!IsLittleEndian())
+        return false;
+
+    Game state;
+    bool loaded = false;
+#if defined(_WIN32)
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    vector<unsigned char> bytes;
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    loaded = ReadSave(bytes.data(), bytes.size(), state);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            loaded = ReadSave((const unsigned char *)mapped, (size_t)info.st_size, state);
+            munmap(mapped, (size_t)info.st_size);
+        }
+    }
+    close(fd);
+#endif
+    if (!loaded)
+        return false;
+
+    state.maxTicksPerFrame = game.maxTicksPerFrame;
+    state.jobs = game.jobs;
+    state.profiler = game.profiler;
+    state.recorder = game.recorder;
+    state.replay = game.replay;
+    // A new layout version makes the renderer rebuild its tower and fence mesh.
+    state.layoutVersion = game.layoutVersion + 1;
+    state.message = game.message;
+    state.messageCount = game.messageCount;
+    game = move(state);
+    return true;
+}
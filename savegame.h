@@ -0,0 +1,12 @@
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+
+struct Game;
+
+// Where the save and load hotkeys keep their single slot.
+const char *const quickSavePath = "kingshot.sav";
+
+bool SaveGame(const Game &game, const char *path);
+bool LoadGame(Game &game, const char *path);
+
+#endif
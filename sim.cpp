@@ -0,0 +1,246 @@
+#include "game.h"
+#include "savegame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+Game game;
+
+void PrintUsage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  -w <waves>      waves to simulate (default 10)\n");
+    printf("  -t <towers>     towers to buy before the first wave, extra buys upgrade (default 4)\n");
+    printf("  -f <fences>     fences to buy before the first wave (default 0)\n");
+    printf("  -r <rate>       simulation tick rate in Hz (default 60)\n");
+    printf("  -l <level>      level to play from %s (default the first)\n", levelsPath);
+    printf("  -e              endless: keep simulating after the player is overrun\n");
+    printf("  -j <threads>    threads for the parallel systems, including this one (default 1)\n");
+    printf("  -T <file>       write a Chrome trace of every tick and task\n");
+    printf("  -R <file>       record the run's commands for replay (not with -e)\n");
+    printf("  -P <file>       replay a recording as fast as possible; -w, -t, -f and -r are ignored\n");
+    printf("  -L <tick>       quick-save to %s before the opening buys and quick-load it at <tick>\n", quickSavePath);
+}
+
+// Plays a recording back into a fresh game and checks it ends where the
+// recorded run did, so anything the recorder misses shows up here.
+bool CheckRecording(const char *path, const LevelSet &levels, const Game &recorded)
+{
+    Replay replay;
+    if (!LoadReplay(replay, path))
+        return false;
+    int level = ReplayLevel(replay, levels);
+    if (level < 0)
+        return false;
+
+    Game check;
+    InitializeGame(check, levels, level);
+    ApplyReplayConfig(replay, check);
+    check.replay = &replay;
+    check.jobs = recorded.jobs;
+    // Counted in steps rather than ticks, as a replay that drifts into game
+    // over stops ticking and would never reach the end of the recording.
+    const float tickTime = 1.0f / check.tickRate;
+    for (unsigned int step = 0; !replay.finished && step <= recorded.tick; step++)
+    {
+        UpdateGame(check, tickTime);
+    }
+    return replay.finished && check.tick == recorded.tick && check.coins == recorded.coins &&
+           check.waveNumber == recorded.waveNumber && check.targets.size() == recorded.targets.size();
+}
+
+int main(int argc, char **argv)
+{
+    int waves = 10;
+    int towers = 4;
+    int fences = 0;
+    bool endless = false;
+    int threads = 1;
+    const char *tracePath = nullptr;
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+    Recorder recorder;
+    Replay replay;
+    const char *levelName = nullptr;
+    long loadTick = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            waves = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            towers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            fences = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            game.tickRate = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+            levelName = argv[++i];
+        else if (strcmp(argv[i], "-e") == 0)
+            endless = true;
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc)
+            loadTick = atol(argv[++i]);
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Endless runs clear gameOver behind the recorder's back, so they cannot be replayed.
+    if (waves <= 0 || game.tickRate <= 0.0f || threads <= 0 || (recordPath && endless))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    LevelSet levels;
+    string error;
+    if (!LoadLevels(levels, levelsPath, levelsCachePath, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    int level = levelName ? FindLevel(levels, levelName) : 0;
+    if (level < 0)
+    {
+        fprintf(stderr, "no level named %s\n", levelName);
+        return 1;
+    }
+    if (replayPath)
+    {
+        if (!LoadReplay(replay, replayPath))
+        {
+            fprintf(stderr, "cannot read %s\n", replayPath);
+            return 1;
+        }
+        level = ReplayLevel(replay, levels);
+        if (level < 0)
+        {
+            fprintf(stderr, "%s was recorded on a level that is not in %s\n", replayPath, levelsPath);
+            return 1;
+        }
+    }
+
+    InitializeGame(game, levels, level);
+    if (replayPath)
+    {
+        ApplyReplayConfig(replay, game);
+        game.replay = &replay;
+        towers = 0;
+        fences = 0;
+        endless = false;
+    }
+    if (recordPath)
+    {
+        if (!StartRecording(recorder, game, recordPath))
+        {
+            fprintf(stderr, "cannot write %s\n", recordPath);
+            return 1;
+        }
+        game.recorder = &recorder;
+    }
+
+    Profiler profiler;
+    if (tracePath)
+    {
+        if (!StartTrace(profiler.tracer, tracePath))
+        {
+            fprintf(stderr, "cannot write %s\n", tracePath);
+            return 1;
+        }
+        game.profiler = &profiler;
+    }
+
+    JobSystem jobs;
+    jobs.profiler = game.profiler;
+    StartJobSystem(jobs, threads - 1);
+    game.jobs = &jobs;
+
+    // Saved before the opening buys, so loading it later undoes them.
+    Command command = {};
+    if (loadTick >= 0)
+    {
+        command.type = COMMAND_SAVE;
+        ApplyCommand(game, command);
+    }
+
+    // Bought through commands so a recording captures them.
+    command.type = COMMAND_BUY_TOWER;
+    for (int i = 0; i < towers; i++)
+    {
+        ApplyCommand(game, command);
+    }
+    command.type = COMMAND_BUY_FENCE;
+    for (int i = 0; i < fences; i++)
+    {
+        ApplyCommand(game, command);
+    }
+
+    const float tickTime = 1.0f / game.tickRate;
+    size_t peakTargets = 0;
+    size_t peakMissiles = 0;
+    int overrun = 0;
+
+    auto start = chrono::steady_clock::now();
+    while (replayPath ? !replay.finished : game.waveNumber <= waves)
+    {
+        if (game.tick == loadTick)
+        {
+            // Loading once is enough; the saved tick comes round again after it.
+            loadTick = -1;
+            command.type = COMMAND_LOAD;
+            ApplyCommand(game, command);
+        }
+        UpdateGame(game, tickTime);
+        peakTargets = max(peakTargets, game.targets.size());
+        peakMissiles = max(peakMissiles, game.missiles.size());
+
+        // A replay keeps going after game over, as the recording may reset and play on.
+        if (game.gameOver && !replayPath)
+        {
+            overrun++;
+            if (!endless)
+                break;
+            game.gameOver = false;
+        }
+    }
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    StopRecording(recorder, game.tick);
+    double simSeconds = game.tick * (double)tickTime;
+
+    printf("level:         %s\n", LevelName(levels, level).c_str());
+    printf("waves:         %d / %d%s\n", game.waveNumber - 1, waves, game.gameOver ? " (game over)" : "");
+    printf("ticks:         %u at %.1f Hz (%.1f s simulated)\n", game.tick, game.tickRate, simSeconds);
+    printf("threads:       %d\n", threads);
+    printf("wall time:     %.3f s\n", wallSeconds);
+    printf("throughput:    %.0f ticks/s (%.1fx real time)\n", game.tick / wallSeconds, simSeconds / wallSeconds);
+    printf("tick cost:     %.3f us\n", wallSeconds * 1e6 / max(1u, game.tick));
+    printf("peak entities: %zu targets, %zu missiles\n", peakTargets, peakMissiles);
+    printf("coins:         %d\n", game.coins);
+    printf("overrun ticks: %d\n", overrun);
+    if (game.message)
+        printf("last message:  %s\n", game.message);
+
+    int status = 0;
+    if (recordPath && !CheckRecording(recordPath, levels, game))
+    {
+        fprintf(stderr, "%s does not replay to the recorded run\n", recordPath);
+        status = 1;
+    }
+
+    StopJobSystem(jobs);
+    StopTrace(profiler.tracer);
+    return status;
+}
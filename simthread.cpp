@@ -0,0 +1,94 @@
+#include "simthread.h"
+
+#include <algorithm>
+#include <chrono>
+
+static void PublishSnapshot(SimThread &sim)
+{
+    CaptureSnapshot(*sim.game, sim.snapshots[sim.back]);
+    lock_guard<mutex> guard(sim.lock);
+    swap(sim.back, sim.ready);
+    sim.fresh = true;
+}
+
+static void SimLoop(SimThread &sim)
+{
+    Game &game = *sim.game;
+    vector<Command> commands;
+    auto last = chrono::steady_clock::now();
+    while (true)
+    {
+        {
+            // Sleep until the next tick is due, or until a command arrives so
+            // input is applied without waiting out the tick.
+            float untilTick = max(0.0f, 1.0f / game.tickRate - game.tickAccumulator);
+            unique_lock<mutex> guard(sim.lock);
+            sim.wake.wait_for(guard, chrono::duration<float>(untilTick),
+                              [&] { return sim.quit || !sim.commands.empty(); });
+            if (sim.quit)
+                return;
+            commands.swap(sim.commands);
+        }
+
+        // Live input is ignored until a replay has played out.
+        bool replaying = game.replay != nullptr && !game.replay->finished;
+        for (const Command &command : commands)
+        {
+            if (!replaying)
+            {
+                ApplyCommand(game, command);
+            }
+        }
+        bool changed = !commands.empty();
+        commands.clear();
+
+        auto now = chrono::steady_clock::now();
+        unsigned int tick = game.tick;
+        StepGame(game, chrono::duration<float>(now - last).count());
+        last = now;
+
+        if (changed || replaying || game.tick != tick)
+        {
+            PublishSnapshot(sim);
+        }
+    }
+}
+
+void StartSimThread(SimThread &sim, Game &game)
+{
+    sim.game = &game;
+    sim.quit = false;
+    CaptureSnapshot(game, sim.snapshots[sim.front]);
+    sim.worker = thread(SimLoop, ref(sim));
+}
+
+void StopSimThread(SimThread &sim)
+{
+    {
+        lock_guard<mutex> guard(sim.lock);
+        sim.quit = true;
+    }
+    sim.wake.notify_one();
+    sim.worker.join();
+}
+
+void PushCommand(SimThread &sim, const Command &command)
+{
+    {
+        lock_guard<mutex> guard(sim.lock);
+        sim.commands.push_back(command);
+    }
+    sim.wake.notify_one();
+}
+
+// The returned snapshot stays untouched until the next call.
+const RenderSnapshot &AcquireSnapshot(SimThread &sim)
+{
+    lock_guard<mutex> guard(sim.lock);
+    if (sim.fresh)
+    {
+        swap(sim.front, sim.ready);
+        sim.fresh = false;
+    }
+    return sim.snapshots[sim.front];
+}
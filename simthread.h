@@ -0,0 +1,37 @@
+#ifndef SIMTHREAD_H
+#define SIMTHREAD_H
+
+#include "game.h"
+#include "snapshot.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs StepGame on its own thread so simulating the next tick overlaps with
+// drawing the last one. The main thread queues commands and draws from a
+// triple buffer of snapshots: the sim fills back, ready holds the newest
+// finished snapshot and the renderer reads front, so neither side waits for
+// the other.
+struct SimThread
+{
+    Game *game = nullptr;
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    vector<Command> commands;
+    RenderSnapshot snapshots[3];
+    int back = 0;
+    int ready = 1;
+    int front = 2;
+    bool fresh = false;
+    bool quit = false;
+};
+
+void StartSimThread(SimThread &sim, Game &game);
+void StopSimThread(SimThread &sim);
+void PushCommand(SimThread &sim, const Command &command);
+const RenderSnapshot &AcquireSnapshot(SimThread &sim);
+
+#endif
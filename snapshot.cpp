@@ -0,0 +1,52 @@
+#include "snapshot.h"
+
+#include <algorithm>
+
+// Only live entities are copied. The vectors are reused, so once they have
+// grown to the size of a wave capturing does not allocate.
+void CaptureSnapshot(const Game &game, RenderSnapshot &snapshot)
+{
+    snapshot.tick = game.tick;
+
+    snapshot.targetPositions.clear();
+    snapshot.targetRadius.clear();
+    for (size_t i = 0; i < game.targets.size(); i++)
+    {
+        if (!game.targets.active[i])
+            continue;
+        snapshot.targetPositions.push_back(TargetPosition(game.targets, i));
+        snapshot.targetRadius.push_back(game.targets.radius[i]);
+    }
+
+    snapshot.missilePositions.clear();
+    for (size_t i = 0; i < game.missiles.count; i++)
+    {
+        if (game.missiles.slots[i].active)
+        {
+            snapshot.missilePositions.push_back(game.missiles.slots[i].position);
+        }
+    }
+
+    snapshot.towers.assign(game.towers.begin(), game.towers.end());
+    snapshot.fences.assign(game.fences.begin(), game.fences.end());
+
+    size_t visiblePaths = min(game.secondPathActive ? (size_t)2 : (size_t)1, game.allWaypoints.size());
+    snapshot.paths.resize(visiblePaths);
+    for (size_t p = 0; p < visiblePaths; p++)
+    {
+        snapshot.paths[p].assign(game.allWaypoints[p].begin(), game.allWaypoints[p].end());
+    }
+
+    snapshot.layoutVersion = game.layoutVersion;
+    snapshot.coins = game.coins;
+    snapshot.enemiesLeft = game.maxEnemies - game.enemiesSpawned;
+    snapshot.waveNumber = game.waveNumber;
+    snapshot.waveActive = game.waveActive;
+    snapshot.waveDelay = game.waves.waveDelay;
+    snapshot.waveDelayTimer = game.waveDelayTimer;
+    snapshot.contactTimer = game.contactTimer;
+    snapshot.pause = game.pause;
+    snapshot.gameOver = game.gameOver;
+    snapshot.message = game.message;
+    snapshot.messageCount = game.messageCount;
+}
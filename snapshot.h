@@ -0,0 +1,33 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game.h"
+
+// Everything RenderGame reads from one simulated tick, copied out of Game so
+// the renderer can draw it while the sim thread moves on to the next tick.
+struct RenderSnapshot
+{
+    unsigned int tick = 0;
+    vector<Vector3> targetPositions;
+    vector<float> targetRadius;
+    vector<Vector3> missilePositions;
+    vector<Tower> towers;
+    vector<Fence> fences;
+    vector<vector<Vector3>> paths;
+    unsigned int layoutVersion = 0;
+    int coins = 0;
+    int enemiesLeft = 0;
+    int waveNumber = 0;
+    bool waveActive = false;
+    float waveDelay = 5.0f;
+    float waveDelayTimer = 0.0f;
+    float contactTimer = 0.0f;
+    bool pause = false;
+    bool gameOver = false;
+    const char *message = nullptr;
+    unsigned int messageCount = 0;
+};
+
+void CaptureSnapshot(const Game &game, RenderSnapshot &snapshot);
+
+#endif
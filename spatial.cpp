@@ -0,0 +1,49 @@
+#include "spatial.h"
+
+void ClearSpatialGrid(SpatialGrid &grid)
+{
+    grid.pendingHash.clear();
+    grid.pendingItem.clear();
+}
+
+void InsertSpatialGrid(SpatialGrid &grid, int item, float x, float z)
+{
+    InsertSpatialGridCell(grid, item, SpatialGridCell(grid, x), SpatialGridCell(grid, z));
+}
+
+// Adds item under one cell; items with an extent are inserted under every cell they cover.
+void InsertSpatialGridCell(SpatialGrid &grid, int item, int cellX, int cellZ)
+{
+    grid.pendingHash.push_back(SpatialGridHash(cellX, cellZ));
+    grid.pendingItem.push_back(item);
+}
+
+void FinishSpatialGrid(SpatialGrid &grid)
+{
+    size_t count = grid.pendingItem.size();
+    unsigned int buckets = 64;
+    while (buckets < count * 2)
+    {
+        buckets *= 2;
+    }
+    grid.mask = buckets - 1;
+
+    grid.cellStart.assign(buckets + 1, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        grid.pendingHash[i] &= grid.mask;
+        grid.cellStart[grid.pendingHash[i] + 1]++;
+    }
+    for (unsigned int b = 0; b < buckets; b++)
+    {
+        grid.cellStart[b + 1] += grid.cellStart[b];
+    }
+
+    // Counting sort keeps insertion order within each bucket.
+    grid.fill.assign(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    grid.items.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        grid.items[grid.fill[grid.pendingHash[i]]++] = grid.pendingItem[i];
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// Uniform grid on the XZ plane, hashed into a power-of-two bucket table so it
+// covers an unbounded world. Items are stored bucket-contiguously after
+// FinishSpatialGrid; queries may see an item twice when two visited cells
+// share a bucket, so callers must tolerate duplicates.
+struct SpatialGrid
+{
+    float cellSize = 2.0f;
+    unsigned int mask = 0;
+    vector<int> cellStart;
+    vector<int> items;
+    vector<unsigned int> pendingHash;
+    vector<int> pendingItem;
+    vector<int> fill;
+};
+
+void ClearSpatialGrid(SpatialGrid &grid);
+void InsertSpatialGrid(SpatialGrid &grid, int item, float x, float z);
+void InsertSpatialGridCell(SpatialGrid &grid, int item, int cellX, int cellZ);
+void FinishSpatialGrid(SpatialGrid &grid);
+
+inline int SpatialGridCell(const SpatialGrid &grid, float coordinate)
+{
+    return (int)floorf(coordinate / grid.cellSize);
+}
+
+inline unsigned int SpatialGridHash(int cellX, int cellZ)
+{
+    return (unsigned int)cellX * 73856093u ^ (unsigned int)cellZ * 19349663u;
+}
+
+// Calls visit(item) for every item in the cells overlapping the square around
+// (x, z) with half extent radius.
+template <typename Fn>
+void QuerySpatialGrid(const SpatialGrid &grid, float x, float z, float radius, Fn visit)
+{
+    if (grid.items.empty())
+        return;
+
+    int minX = SpatialGridCell(grid, x - radius);
+    int maxX = SpatialGridCell(grid, x + radius);
+    int minZ = SpatialGridCell(grid, z - radius);
+    int maxZ = SpatialGridCell(grid, z + radius);
+    if ((double)(maxX - minX + 1) * (maxZ - minZ + 1) > grid.mask)
+    {
+        for (int item : grid.items)
+        {
+            visit(item);
+        }
+        return;
+    }
+
+    for (int cellX = minX; cellX <= maxX; cellX++)
+    {
+        for (int cellZ = minZ; cellZ <= maxZ; cellZ++)
+        {
+            unsigned int bucket = SpatialGridHash(cellX, cellZ) & grid.mask;
+            for (int i = grid.cellStart[bucket]; i < grid.cellStart[bucket + 1]; i++)
+            {
+                visit(grid.items[i]);
+            }
+        }
+    }
+}
+
+// Returns the item with the smallest distance(item) below maxDistance, or -1.
+// Rings of cells are searched outward from (x, z) and the search stops once no
+// unvisited cell can hold anything closer, so distance must never be less than
+// the XZ distance to the item. Ties go to the lower item.
+template <typename Fn>
+int FindNearestSpatialGrid(const SpatialGrid &grid, float x, float z, float maxDistance, Fn distance)
+{
+    int best = -1;
+    float bestDist = maxDistance;
+    auto consider = [&](int item) {
+        float dist = distance(item);
+        if (dist < bestDist || (dist == bestDist && best >= 0 && item < best))
+        {
+            bestDist = dist;
+            best = item;
+        }
+    };
+
+    if (grid.items.empty())
+        return -1;
+
+    int maxRing = (int)ceilf(maxDistance / grid.cellSize);
+    if ((double)(2 * maxRing + 1) * (2 * maxRing + 1) > grid.mask)
+    {
+        for (int item : grid.items)
+        {
+            consider(item);
+        }
+        return best;
+    }
+
+    int centerX = SpatialGridCell(grid, x);
+    int centerZ = SpatialGridCell(grid, z);
+    auto visitCell = [&](int cellX, int cellZ) {
+        unsigned int bucket = SpatialGridHash(cellX, cellZ) & grid.mask;
+        for (int i = grid.cellStart[bucket]; i < grid.cellStart[bucket + 1]; i++)
+        {
+            consider(grid.items[i]);
+        }
+    };
+
+    visitCell(centerX, centerZ);
+    for (int ring = 1; ring <= maxRing; ring++)
+    {
+        if (best >= 0 && bestDist < (ring - 1) * grid.cellSize)
+            break;
+        for (int d = -ring; d <= ring; d++)
+        {
+            visitCell(centerX + d, centerZ - ring);
+            visitCell(centerX + d, centerZ + ring);
+        }
+        for (int d = -ring + 1; d < ring; d++)
+        {
+            visitCell(centerX - ring, centerZ + d);
+            visitCell(centerX + ring, centerZ + d);
+        }
+    }
+    return best;
+}
+
+#endif
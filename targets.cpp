@@ -0,0 +1,181 @@
+#include "game.h"
+#include "raymath.h"
+
+#include <algorithm>
+#include <cmath>
+
+Handle AddTarget(TargetPool &pool, const Target &target)
+{
+    pool.x.push_back(target.position.x);
+    pool.y.push_back(target.position.y);
+    pool.z.push_back(target.position.z);
+    pool.radius.push_back(target.radius);
+    pool.speed.push_back(target.speed);
+    pool.lifeTimer.push_back(target.lifeTimer);
+    pool.lifeTimeLimit.push_back(target.lifeTimeLimit);
+    pool.pathDistance.push_back(target.pathDistance);
+    pool.pathSegment.push_back(target.pathSegment);
+    pool.pathIndex.push_back(target.pathIndex);
+    pool.active.push_back(target.active);
+    pool.stopped.push_back(target.stopped);
+    return CreateHandle(pool.handles);
+}
+
+Target GetTarget(const TargetPool &pool, size_t i)
+{
+    Target target;
+    target.position = TargetPosition(pool, i);
+    target.radius = pool.radius[i];
+    target.active = pool.active[i];
+    target.speed = pool.speed[i];
+    target.pathDistance = pool.pathDistance[i];
+    target.pathSegment = pool.pathSegment[i];
+    target.stopped = pool.stopped[i];
+    target.pathIndex = pool.pathIndex[i];
+    target.lifeTimer = pool.lifeTimer[i];
+    target.lifeTimeLimit = pool.lifeTimeLimit[i];
+    return target;
+}
+
+Vector3 TargetPosition(const TargetPool &pool, size_t i)
+{
+    return (Vector3){pool.x[i], pool.y[i], pool.z[i]};
+}
+
+template <typename T>
+void CompactArray(vector<T> &values, const vector<unsigned char> &keep)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (keep[i])
+        {
+            values[out++] = values[i];
+        }
+    }
+    values.resize(out);
+}
+
+void RemoveInactiveTargets(TargetPool &pool)
+{
+    // active is the keep mask for every other array, so it is compacted last.
+    CompactHandles(pool.handles, [&](size_t i) { return pool.active[i] != 0; });
+    CompactArray(pool.x, pool.active);
+    CompactArray(pool.y, pool.active);
+    CompactArray(pool.z, pool.active);
+    CompactArray(pool.radius, pool.active);
+    CompactArray(pool.speed, pool.active);
+    CompactArray(pool.lifeTimer, pool.active);
+    CompactArray(pool.lifeTimeLimit, pool.active);
+    CompactArray(pool.pathDistance, pool.active);
+    CompactArray(pool.pathSegment, pool.active);
+    CompactArray(pool.pathIndex, pool.active);
+    CompactArray(pool.stopped, pool.active);
+    CompactArray(pool.active, pool.active);
+}
+
+void ClearTargets(TargetPool &pool)
+{
+    pool.x.clear();
+    pool.y.clear();
+    pool.z.clear();
+    pool.radius.clear();
+    pool.speed.clear();
+    pool.lifeTimer.clear();
+    pool.lifeTimeLimit.clear();
+    pool.pathDistance.clear();
+    pool.pathSegment.clear();
+    pool.pathIndex.clear();
+    pool.active.clear();
+    pool.stopped.clear();
+    ClearHandles(pool.handles);
+}
+
+// Targets stop once they are within arrivalDistance of their last waypoint.
+void BuildPaths(Game &game)
+{
+    game.paths.resize(game.allWaypoints.size());
+    for (size_t p = 0; p < game.allWaypoints.size(); p++)
+    {
+        const vector<Vector3> &waypoints = game.allWaypoints[p];
+        Path &path = game.paths[p];
+        path.segmentStart.assign(1, 0.0f);
+        path.direction.clear();
+        for (size_t s = 0; s + 1 < waypoints.size(); s++)
+        {
+            Vector3 delta = Vector3Subtract(waypoints[s + 1], waypoints[s]);
+            float length = Vector3Length(delta);
+            path.direction.push_back(length > 0.0f ? Vector3Scale(delta, 1.0f / length) : Vector3Zero());
+            path.segmentStart.push_back(path.segmentStart.back() + length);
+        }
+        path.length = path.segmentStart.back();
+        path.stopDistance = max(0.0f, path.length - arrivalDistance);
+    }
+}
+
+// Returns the point distance along the path. Targets only move forward, so
+// segment is the one the caller was on and is stepped up to the one holding
+// distance, usually not at all. The path needs at least two waypoints.
+Vector3 PathPosition(const vector<Vector3> &waypoints, const Path &path, float distance, int &segment)
+{
+    int lastSegment = (int)path.direction.size() - 1;
+    while (segment < lastSegment && distance >= path.segmentStart[segment + 1])
+    {
+        segment++;
+    }
+    return Vector3Add(waypoints[segment], Vector3Scale(path.direction[segment], distance - path.segmentStart[segment]));
+}
+
+// Steps every target that has not arrived along the flow field, or straight
+// at the player where the field gives no direction.
+static void MoveTargetsFlowField(Game &game, float dt, size_t begin, size_t end)
+{
+    const Vector3 playerPosition = (Vector3){0.0f, 0.1f, 0.0f};
+    TargetPool &pool = game.targets;
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!pool.active[i] || pool.stopped[i])
+            continue;
+        float toPlayerX = playerPosition.x - pool.x[i];
+        float toPlayerZ = playerPosition.z - pool.z[i];
+        float distance = sqrtf(toPlayerX * toPlayerX + toPlayerZ * toPlayerZ);
+        if (distance < arrivalDistance)
+            continue;
+        float directionX;
+        float directionZ;
+        if (!SampleFlowField(game.flowField, pool.x[i], pool.z[i], directionX, directionZ))
+        {
+            directionX = toPlayerX / distance;
+            directionZ = toPlayerZ / distance;
+        }
+        float step = pool.speed[i] * dt;
+        pool.x[i] += directionX * step;
+        pool.z[i] += directionZ * step;
+    }
+}
+
+// Moves every active target in [begin, end) that no fence is holding
+// speed * dt further along its path and rederives its position.
+void MoveTargets(Game &game, float dt, size_t begin, size_t end)
+{
+    if (game.navigation == NAVIGATION_FLOW_FIELD)
+    {
+        MoveTargetsFlowField(game, dt, begin, end);
+        return;
+    }
+
+    TargetPool &pool = game.targets;
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!pool.active[i] || pool.stopped[i])
+            continue;
+        int p = pool.pathIndex[i];
+        const Path &path = game.paths[p];
+        float distance = min(pool.pathDistance[i] + pool.speed[i] * dt, path.stopDistance);
+        pool.pathDistance[i] = distance;
+        Vector3 position = PathPosition(game.allWaypoints[p], path, distance, pool.pathSegment[i]);
+        pool.x[i] = position.x;
+        pool.y[i] = position.y;
+        pool.z[i] = position.z;
+    }
+}